@@ -0,0 +1,275 @@
+/*
+ * Micro-benchmark for the Q conversion macros and array kernels.
+ *
+ * Build:  gcc -std=c99 -O2 -march=native -o benchmark benchmark.c
+ * Run:    ./benchmark [size_kib ...] > bench.csv
+ *
+ * For every word size it times the scalar macros (Q7_b8 .. Q63_b64,
+ * F_Q7b8 .. F_Q63b64 in a loop) and the array functions from q_array.h,
+ * plus the table lookup decode from q_lut.h for 8 and 16 bit ("lut"),
+ * over a sweep of buffer sizes (default 16 KiB, 256 KiB, 8 MiB, 128 MiB of
+ * float input: L1, L2, LLC, DRAM) and three input distributions:
+ *   inrange  - all values inside F_MINbxx(N) .. F_MAXbxx(N)
+ *   saturate - all values outside, both signs
+ *   mixed    - random mix of the two, worst case for branchy saturation
+ *
+ * Output is CSV on stdout, one row per measurement:
+ *   op,impl,isa,word,N,dist,bytes,elements,ns_per_elem,gb_per_s
+ * isa is the kernel tier the array functions run (q_isa()), set Q_ISA=sse2,
+ * avx2, ... to compare tiers. bytes is input plus output size; the best of
+ * several runs is reported. Build with -DQ_SAT_COUNT -pthread to measure
+ * the cost of the saturation counters (q_sat.h).
+ * */
+#define _POSIX_C_SOURCE 199309L
+
+#include "q_array.h"
+#include "q_lut.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_RUNS      5           /* Best of. */
+#define BENCH_MIN_NS    20000000.0  /* Repeat each run until it takes at least 20 ms. */
+
+typedef enum { DIST_INRANGE, DIST_SATURATE, DIST_MIXED } dist_t;
+
+static const char *dist_name[] = { "inrange", "saturate", "mixed" };
+
+/* Keeps the optimizer from dropping the converted buffers. */
+static volatile uint64_t bench_sink;
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static uint32_t rng_state = 0x12345678U;
+
+static float32_t rng_unit(void)     /* [0, 1) */
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return (float32_t)(rng_state >> 8) * (1.0f / 16777216.0f);
+}
+
+static void fill_float(float32_t *x, size_t n, float32_t fmax, dist_t dist)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        float32_t sign = rng_unit() < 0.5f ? -1.0f : 1.0f;
+        int       out  = dist == DIST_SATURATE || (dist == DIST_MIXED && rng_unit() < 0.5f);
+        x[i] = out ? sign * fmax * (1.1f + rng_unit()) : sign * fmax * 0.99f * rng_unit();
+    }
+}
+
+static void fill_bytes(void *p, size_t bytes)
+{
+    uint8_t *b = (uint8_t *)p;
+    for (size_t i = 0; i < bytes; i++)
+    {
+        b[i] = (uint8_t)(rng_unit() * 256.0f);
+    }
+}
+
+
+// Scalar macro loops, constant N as in user code. noinline so every variant is timed as a call.
+
+#define BENCH_ENC_MACRO(NAME, T, MACRO)                                         \
+    static __attribute__((noinline)) void NAME(void *d, const void *s, size_t n) \
+    {                                                                           \
+        T               *dst = (T *)d;                                          \
+        const float32_t *src = (const float32_t *)s;                            \
+        for (size_t i = 0; i < n; i++)                                          \
+        {                                                                       \
+            dst[i] = MACRO(src[i]);                                             \
+        }                                                                       \
+    }
+
+#define BENCH_DEC_MACRO(NAME, T, MACRO)                                         \
+    static __attribute__((noinline)) void NAME(void *d, const void *s, size_t n) \
+    {                                                                           \
+        float32_t *dst = (float32_t *)d;                                        \
+        const T   *src = (const T *)s;                                          \
+        for (size_t i = 0; i < n; i++)                                          \
+        {                                                                       \
+            dst[i] = MACRO(src[i]);                                             \
+        }                                                                       \
+    }
+
+BENCH_ENC_MACRO(enc_macro_b08, fix8_t,  Q7_b8)
+BENCH_ENC_MACRO(enc_macro_b16, fix16_t, Q15_b16)
+BENCH_ENC_MACRO(enc_macro_b32, fix32_t, Q31_b32)
+BENCH_ENC_MACRO(enc_macro_b64, fix64_t, Q63_b64)
+BENCH_DEC_MACRO(dec_macro_b08, fix8_t,  F_Q7b8)
+BENCH_DEC_MACRO(dec_macro_b16, fix16_t, F_Q15b16)
+BENCH_DEC_MACRO(dec_macro_b32, fix32_t, F_Q31b32)
+BENCH_DEC_MACRO(dec_macro_b64, fix64_t, F_Q63b64)
+
+#define BENCH_ENC_ARRAY(NAME, T, FN, N)                                         \
+    static __attribute__((noinline)) void NAME(void *dst, const void *src, size_t n) \
+    {                                                                           \
+        FN(N, (T *)dst, (const float32_t *)src, n);                             \
+    }
+
+#define BENCH_DEC_ARRAY(NAME, T, FN, N)                                         \
+    static __attribute__((noinline)) void NAME(void *dst, const void *src, size_t n) \
+    {                                                                           \
+        FN(N, (float32_t *)dst, (const T *)src, n);                             \
+    }
+
+BENCH_ENC_ARRAY(enc_array_b08, fix8_t,  Qx_b08_array,  7)
+BENCH_ENC_ARRAY(enc_array_b16, fix16_t, Qx_b16_array, 15)
+BENCH_ENC_ARRAY(enc_array_b32, fix32_t, Qx_b32_array, 31)
+BENCH_ENC_ARRAY(enc_array_b64, fix64_t, Qx_b64_array, 63)
+BENCH_DEC_ARRAY(dec_array_b08, fix8_t,  F_Qx_b08_array,  7)
+BENCH_DEC_ARRAY(dec_array_b16, fix16_t, F_Qx_b16_array, 15)
+BENCH_DEC_ARRAY(dec_array_b32, fix32_t, F_Qx_b32_array, 31)
+BENCH_DEC_ARRAY(dec_array_b64, fix64_t, F_Qx_b64_array, 63)
+
+static const q_lut8_t  bench_lut8 = Q_LUT8(7);
+static q_lut16_t      *bench_lut16;     /* Q15, built in main(). */
+
+static __attribute__((noinline)) void dec_lut_b08(void *dst, const void *src, size_t n)
+{
+    q_lut8_array(&bench_lut8, (float32_t *)dst, (const fix8_t *)src, n);
+}
+
+static __attribute__((noinline)) void dec_lut_b16(void *dst, const void *src, size_t n)
+{
+    q_lut16_array(bench_lut16, (float32_t *)dst, (const fix16_t *)src, n);
+}
+
+
+/* One benchmark case: fn(dst, src, n) with element sizes in/out. Every fn has this exact type. */
+typedef struct
+{
+    const char   *op;           /* "encode" or "decode" */
+    const char   *impl;         /* "macro", "array" or "lut" */
+    unsigned int  word;         /* 8, 16, 32, 64 */
+    unsigned int  N;
+    void        (*fn)(void *dst, const void *src, size_t n);
+} bench_case_t;
+
+#define CASE(OP, IMPL, W, N, FN) { OP, IMPL, W, N, FN }
+
+static const bench_case_t cases[] =
+{
+    CASE("encode", "macro",  8,  7, enc_macro_b08), CASE("encode", "array",  8,  7, enc_array_b08),
+    CASE("encode", "macro", 16, 15, enc_macro_b16), CASE("encode", "array", 16, 15, enc_array_b16),
+    CASE("encode", "macro", 32, 31, enc_macro_b32), CASE("encode", "array", 32, 31, enc_array_b32),
+    CASE("encode", "macro", 64, 63, enc_macro_b64), CASE("encode", "array", 64, 63, enc_array_b64),
+    CASE("decode", "macro",  8,  7, dec_macro_b08), CASE("decode", "array",  8,  7, dec_array_b08),
+    CASE("decode", "lut",    8,  7, dec_lut_b08),
+    CASE("decode", "macro", 16, 15, dec_macro_b16), CASE("decode", "array", 16, 15, dec_array_b16),
+    CASE("decode", "lut",   16, 15, dec_lut_b16),
+    CASE("decode", "macro", 32, 31, dec_macro_b32), CASE("decode", "array", 32, 31, dec_array_b32),
+    CASE("decode", "macro", 64, 63, dec_macro_b64), CASE("decode", "array", 64, 63, dec_array_b64),
+};
+
+/* Returns best ns per call. */
+static double time_case(const bench_case_t *c, void *dst, const void *src, size_t n)
+{
+    double best = 1e300;
+    size_t reps = 1;
+
+    c->fn(dst, src, n);     /* Warm up, fault in pages. */
+    for (;;)
+    {
+        double t0 = now_ns();
+        for (size_t r = 0; r < reps; r++)
+        {
+            c->fn(dst, src, n);
+        }
+        double t = now_ns() - t0;
+        if (t >= BENCH_MIN_NS || reps >= ((size_t)1 << 30))
+        {
+            best = t / (double)reps;
+            break;
+        }
+        reps *= 2;
+    }
+    for (int run = 1; run < BENCH_RUNS; run++)
+    {
+        double t0 = now_ns();
+        for (size_t r = 0; r < reps; r++)
+        {
+            c->fn(dst, src, n);
+        }
+        double t = (now_ns() - t0) / (double)reps;
+        best = t < best ? t : best;
+    }
+    bench_sink += ((const uint8_t *)dst)[n / 2];
+    return best;
+}
+
+int main(int argc, char **argv)
+{
+    size_t def_kib[] = { 16, 256, 8 * 1024, 128 * 1024 };
+    size_t nsizes    = argc > 1 ? (size_t)(argc - 1) : sizeof(def_kib) / sizeof(def_kib[0]);
+    size_t max_bytes = 0;
+
+    for (size_t s = 0; s < nsizes; s++)
+    {
+        size_t kib = argc > 1 ? (size_t)strtoull(argv[s + 1], NULL, 10) : def_kib[s];
+        max_bytes  = kib * 1024 > max_bytes ? kib * 1024 : max_bytes;
+    }
+
+    /* Input sized for float32 at max_bytes; output up to 2x (fix64_t). */
+    size_t max_n = max_bytes / sizeof(float32_t);
+    void  *src   = malloc(max_n * sizeof(fix64_t));
+    void  *dst   = malloc(max_n * sizeof(fix64_t));
+    bench_lut16  = (q_lut16_t *)malloc(sizeof(q_lut16_t));
+    if (src == NULL || dst == NULL || bench_lut16 == NULL || max_n == 0)
+    {
+        fprintf(stderr, "benchmark: cannot allocate %zu bytes\n", 2 * max_n * sizeof(fix64_t));
+        return 1;
+    }
+    memset(dst, 0, max_n * sizeof(fix64_t));
+    q_lut16_init(bench_lut16, 15, 1.0f);
+
+    printf("op,impl,isa,word,N,dist,bytes,elements,ns_per_elem,gb_per_s\n");
+    for (size_t s = 0; s < nsizes; s++)
+    {
+        size_t kib = argc > 1 ? (size_t)strtoull(argv[s + 1], NULL, 10) : def_kib[s];
+        size_t n   = kib * 1024 / sizeof(float32_t);
+
+        for (size_t k = 0; k < sizeof(cases) / sizeof(cases[0]); k++)
+        {
+            const bench_case_t *c = &cases[k];
+            int    enc    = c->op[0] == 'e';
+            size_t wbytes = c->word / 8;
+            size_t bytes  = n * (sizeof(float32_t) + wbytes);
+            float32_t fmax = (float32_t)(1ULL << (c->word - 1 - c->N));
+
+            for (int d = DIST_INRANGE; d <= DIST_MIXED; d++)
+            {
+                if (!enc && d != DIST_INRANGE)
+                {
+                    continue;   /* Decode has no saturation, one distribution is enough. */
+                }
+                if (enc)
+                {
+                    fill_float((float32_t *)src, n, fmax, (dist_t)d);
+                }
+                else
+                {
+                    fill_bytes(src, n * wbytes);
+                }
+                double ns = time_case(c, dst, src, n);
+                printf("%s,%s,%s,%u,%u,%s,%zu,%zu,%.4f,%.3f\n", c->op, c->impl,
+                       c->impl[0] != 'm' ? q_isa_name(q_isa()) : "-", c->word, c->N,
+                       enc ? dist_name[d] : "random", bytes, n, ns / (double)n, (double)bytes / ns);
+                fflush(stdout);
+            }
+        }
+    }
+
+    free(src);
+    free(dst);
+    free(bench_lut16);
+    return 0;
+}
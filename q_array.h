@@ -0,0 +1,997 @@
+/**
+ * @file    q_array.h
+ * @brief   Float-to-fixed and fixed-to-float conversion of whole arrays for
+ *          8, 16, 32 and 64 bit words.
+ *
+ *          Qx_bxx_array() gives bit-identical results to calling Qx_bxx() from
+ *          q_macros.h on every element: values at or above F_MAXbxx(N) become
+ *          Q_MAXbxx, values below F_MINbxx(N) become Q_MINbxx, everything else
+ *          is truncated toward zero.
+ *
+ *          F_Qx_bxx_array() gives bit-identical results to F_Qx_bxx(): the
+ *          integer is converted once and multiplied by the exact reciprocal
+ *          2^-N, no division. F_Qx_bxx_array_d() does the same into float64.
+ *
+ *          Qx_b32_array_d() and Qx_b64_array_d() convert from float64 with the
+ *          same rules as Qx_b32_d()/Qx_b64_d(), keeping all 53 mantissa bits.
+ *
+ *          Saturation is done with vector min/max in the scaled domain, so the
+ *          SIMD loops have no branches. Kernels are picked once at startup
+ *          from what the CPU supports, see q_simd.h.
+ *
+ * @note    NaN input is undefined, same as with the scalar macros.
+ */
+
+#ifndef SRC_Q_ARRAY_H_
+#define SRC_Q_ARRAY_H_
+
+
+#include "q_macros.h"
+#include "q_sat.h"
+#include "q_simd.h"
+#include <stddef.h>
+
+
+// Plain C kernels, reference for all others.
+
+/** @brief Converts n float32 values to 8-bit Qn with Qx_b08(). @note RARELY USE DIRECTLY. */
+static inline void q_f32_to_b08_c(unsigned int N, fix8_t *dst, const float32_t *src, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        dst[i] = Qx_b08(N, src[i]);
+    }
+}
+
+/** @brief Converts n float32 values to 16-bit Qn with Qx_b16(). @note RARELY USE DIRECTLY. */
+static inline void q_f32_to_b16_c(unsigned int N, fix16_t *dst, const float32_t *src, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        dst[i] = Qx_b16(N, src[i]);
+    }
+}
+
+/** @brief Converts n float32 values to 32-bit Qn with Qx_b32(). @note RARELY USE DIRECTLY. */
+static inline void q_f32_to_b32_c(unsigned int N, fix32_t *dst, const float32_t *src, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        dst[i] = Qx_b32(N, src[i]);
+    }
+}
+
+/** @brief Converts n float32 values to 64-bit Qn with Qx_b64(). @note RARELY USE DIRECTLY. */
+static inline void q_f32_to_b64_c(unsigned int N, fix64_t *dst, const float32_t *src, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        dst[i] = Qx_b64(N, src[i]);
+    }
+}
+
+
+#if Q_SIMD_SSE2
+Q_TARGET_SSE2_BEGIN
+
+/*
+ * 8 and 16 bit: clamp scaled value to [Q_MINbxx, Q_MAXbxx] (both exact in float32),
+ * truncate, pack. 32 bit: Q_MAXb32 is not a float32, so rely on cvttps returning
+ * 0x80000000 on overflow - correct for the negative side, flipped to 0x7FFFFFFF
+ * on the positive side with a compare mask.
+ */
+
+static inline void q_f32_to_b08_sse2(unsigned int N, fix8_t *dst, const float32_t *src, size_t n)
+{
+    const __m128 scale = _mm_set1_ps((float32_t)SCALE_FACTOR_08(N));
+    const __m128 hi    = _mm_set1_ps((float32_t)Q_MAXb08);
+    const __m128 lo    = _mm_set1_ps((float32_t)Q_MINb08);
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128 a = _mm_mul_ps(_mm_loadu_ps(src + i     ), scale);
+        __m128 b = _mm_mul_ps(_mm_loadu_ps(src + i +  4), scale);
+        __m128 c = _mm_mul_ps(_mm_loadu_ps(src + i +  8), scale);
+        __m128 d = _mm_mul_ps(_mm_loadu_ps(src + i + 12), scale);
+        a = _mm_max_ps(_mm_min_ps(a, hi), lo);
+        b = _mm_max_ps(_mm_min_ps(b, hi), lo);
+        c = _mm_max_ps(_mm_min_ps(c, hi), lo);
+        d = _mm_max_ps(_mm_min_ps(d, hi), lo);
+        __m128i ab = _mm_packs_epi32(_mm_cvttps_epi32(a), _mm_cvttps_epi32(b));
+        __m128i cd = _mm_packs_epi32(_mm_cvttps_epi32(c), _mm_cvttps_epi32(d));
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_packs_epi16(ab, cd));
+    }
+    q_f32_to_b08_c(N, dst + i, src + i, n - i);
+}
+
+static inline void q_f32_to_b16_sse2(unsigned int N, fix16_t *dst, const float32_t *src, size_t n)
+{
+    const __m128 scale = _mm_set1_ps((float32_t)SCALE_FACTOR_16(N));
+    const __m128 hi    = _mm_set1_ps((float32_t)Q_MAXb16);
+    const __m128 lo    = _mm_set1_ps((float32_t)Q_MINb16);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128 a = _mm_mul_ps(_mm_loadu_ps(src + i    ), scale);
+        __m128 b = _mm_mul_ps(_mm_loadu_ps(src + i + 4), scale);
+        a = _mm_max_ps(_mm_min_ps(a, hi), lo);
+        b = _mm_max_ps(_mm_min_ps(b, hi), lo);
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_packs_epi32(_mm_cvttps_epi32(a), _mm_cvttps_epi32(b)));
+    }
+    q_f32_to_b16_c(N, dst + i, src + i, n - i);
+}
+
+static inline void q_f32_to_b32_sse2(unsigned int N, fix32_t *dst, const float32_t *src, size_t n)
+{
+    const __m128 scale = _mm_set1_ps((float32_t)SCALE_FACTOR_32(N));
+    const __m128 ovf   = _mm_set1_ps(2147483648.0f);
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128  a = _mm_mul_ps(_mm_loadu_ps(src + i), scale);
+        __m128i m = _mm_castps_si128(_mm_cmpge_ps(a, ovf));
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_xor_si128(_mm_cvttps_epi32(a), m));
+    }
+    q_f32_to_b32_c(N, dst + i, src + i, n - i);
+}
+
+Q_TARGET_END
+#endif /* Q_SIMD_SSE2 */
+
+
+#if Q_SIMD_AVX2
+Q_TARGET_AVX2_BEGIN
+
+static inline void q_f32_to_b08_avx2(unsigned int N, fix8_t *dst, const float32_t *src, size_t n)
+{
+    const __m256  scale = _mm256_set1_ps((float32_t)SCALE_FACTOR_08(N));
+    const __m256  hi    = _mm256_set1_ps((float32_t)Q_MAXb08);
+    const __m256  lo    = _mm256_set1_ps((float32_t)Q_MINb08);
+    const __m256i perm  = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    size_t i = 0;
+
+    for (; i + 32 <= n; i += 32)
+    {
+        __m256 a = _mm256_mul_ps(_mm256_loadu_ps(src + i     ), scale);
+        __m256 b = _mm256_mul_ps(_mm256_loadu_ps(src + i +  8), scale);
+        __m256 c = _mm256_mul_ps(_mm256_loadu_ps(src + i + 16), scale);
+        __m256 d = _mm256_mul_ps(_mm256_loadu_ps(src + i + 24), scale);
+        a = _mm256_max_ps(_mm256_min_ps(a, hi), lo);
+        b = _mm256_max_ps(_mm256_min_ps(b, hi), lo);
+        c = _mm256_max_ps(_mm256_min_ps(c, hi), lo);
+        d = _mm256_max_ps(_mm256_min_ps(d, hi), lo);
+        __m256i ab = _mm256_packs_epi32(_mm256_cvttps_epi32(a), _mm256_cvttps_epi32(b));
+        __m256i cd = _mm256_packs_epi32(_mm256_cvttps_epi32(c), _mm256_cvttps_epi32(d));
+        /* packs works per 128-bit lane, put the 4-byte groups back in order. */
+        __m256i r  = _mm256_permutevar8x32_epi32(_mm256_packs_epi16(ab, cd), perm);
+        _mm256_storeu_si256((__m256i *)(dst + i), r);
+    }
+    q_f32_to_b08_c(N, dst + i, src + i, n - i);
+}
+
+static inline void q_f32_to_b16_avx2(unsigned int N, fix16_t *dst, const float32_t *src, size_t n)
+{
+    const __m256 scale = _mm256_set1_ps((float32_t)SCALE_FACTOR_16(N));
+    const __m256 hi    = _mm256_set1_ps((float32_t)Q_MAXb16);
+    const __m256 lo    = _mm256_set1_ps((float32_t)Q_MINb16);
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m256 a = _mm256_mul_ps(_mm256_loadu_ps(src + i    ), scale);
+        __m256 b = _mm256_mul_ps(_mm256_loadu_ps(src + i + 8), scale);
+        a = _mm256_max_ps(_mm256_min_ps(a, hi), lo);
+        b = _mm256_max_ps(_mm256_min_ps(b, hi), lo);
+        __m256i r = _mm256_packs_epi32(_mm256_cvttps_epi32(a), _mm256_cvttps_epi32(b));
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_permute4x64_epi64(r, 0xD8));
+    }
+    q_f32_to_b16_c(N, dst + i, src + i, n - i);
+}
+
+static inline void q_f32_to_b32_avx2(unsigned int N, fix32_t *dst, const float32_t *src, size_t n)
+{
+    const __m256 scale = _mm256_set1_ps((float32_t)SCALE_FACTOR_32(N));
+    const __m256 ovf   = _mm256_set1_ps(2147483648.0f);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256  a = _mm256_mul_ps(_mm256_loadu_ps(src + i), scale);
+        __m256i m = _mm256_castps_si256(_mm256_cmp_ps(a, ovf, _CMP_GE_OQ));
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_xor_si256(_mm256_cvttps_epi32(a), m));
+    }
+    q_f32_to_b32_c(N, dst + i, src + i, n - i);
+}
+
+Q_TARGET_END
+#endif /* Q_SIMD_AVX2 */
+
+
+#if Q_SIMD_AVX512
+Q_TARGET_AVX512_BEGIN
+
+static inline void q_f32_to_b08_avx512(unsigned int N, fix8_t *dst, const float32_t *src, size_t n)
+{
+    const __m512 scale = _mm512_set1_ps((float32_t)SCALE_FACTOR_08(N));
+    const __m512 hi    = _mm512_set1_ps((float32_t)Q_MAXb08);
+    const __m512 lo    = _mm512_set1_ps((float32_t)Q_MINb08);
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m512 a = _mm512_mul_ps(_mm512_loadu_ps(src + i), scale);
+        a = _mm512_max_ps(_mm512_min_ps(a, hi), lo);
+        _mm_storeu_si128((__m128i *)(dst + i), _mm512_cvtepi32_epi8(_mm512_cvttps_epi32(a)));
+    }
+    q_f32_to_b08_c(N, dst + i, src + i, n - i);
+}
+
+static inline void q_f32_to_b16_avx512(unsigned int N, fix16_t *dst, const float32_t *src, size_t n)
+{
+    const __m512 scale = _mm512_set1_ps((float32_t)SCALE_FACTOR_16(N));
+    const __m512 hi    = _mm512_set1_ps((float32_t)Q_MAXb16);
+    const __m512 lo    = _mm512_set1_ps((float32_t)Q_MINb16);
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m512 a = _mm512_mul_ps(_mm512_loadu_ps(src + i), scale);
+        a = _mm512_max_ps(_mm512_min_ps(a, hi), lo);
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm512_cvtepi32_epi16(_mm512_cvttps_epi32(a)));
+    }
+    q_f32_to_b16_c(N, dst + i, src + i, n - i);
+}
+
+static inline void q_f32_to_b32_avx512(unsigned int N, fix32_t *dst, const float32_t *src, size_t n)
+{
+    const __m512  scale = _mm512_set1_ps((float32_t)SCALE_FACTOR_32(N));
+    const __m512  ovf   = _mm512_set1_ps(2147483648.0f);
+    const __m512i qmax  = _mm512_set1_epi32(Q_MAXb32);
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m512    a = _mm512_mul_ps(_mm512_loadu_ps(src + i), scale);
+        __mmask16 m = _mm512_cmp_ps_mask(a, ovf, _CMP_GE_OQ);
+        _mm512_storeu_si512((void *)(dst + i), _mm512_mask_mov_epi32(_mm512_cvttps_epi32(a), m, qmax));
+    }
+    q_f32_to_b32_c(N, dst + i, src + i, n - i);
+}
+
+static inline void q_f32_to_b64_avx512(unsigned int N, fix64_t *dst, const float32_t *src, size_t n)
+{
+    const __m256  scale = _mm256_set1_ps((float32_t)SCALE_FACTOR_64(N));
+    const __m256  ovf   = _mm256_set1_ps(9223372036854775808.0f);
+    const __m512i qmax  = _mm512_set1_epi64(Q_MAXb64);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256   a = _mm256_mul_ps(_mm256_loadu_ps(src + i), scale);
+        __mmask8 m = _mm256_cmp_ps_mask(a, ovf, _CMP_GE_OQ);
+        _mm512_storeu_si512((void *)(dst + i), _mm512_mask_mov_epi64(_mm512_cvttps_epi64(a), m, qmax));
+    }
+    q_f32_to_b64_c(N, dst + i, src + i, n - i);
+}
+
+Q_TARGET_END
+#endif /* Q_SIMD_AVX512 */
+
+
+// Fixed-to-float kernels. Multiply by the exact reciprocal 2^-N, same result as F_Qx_bxx().
+
+/** @brief Exact float32 reciprocal of SCALE_FACTOR_xx(N). */
+#define Q_RECIP_F32(N)  ( 1.0f/(float32_t)SCALE_FACTOR_64(N) )
+/** @brief Exact float64 reciprocal of SCALE_FACTOR_xx(N). */
+#define Q_RECIP_F64(N)  ( 1.0 /(float64_t)SCALE_FACTOR_64(N) )
+
+/** @brief Converts n 8-bit Qn values to float32, same as F_Qx_b08(). @note RARELY USE DIRECTLY. */
+static inline void q_b08_to_f32_c(unsigned int N, float32_t *dst, const fix8_t *src, size_t n)
+{
+    const float32_t r = Q_RECIP_F32(N);
+    for (size_t i = 0; i < n; i++)
+    {
+        dst[i] = (float32_t)src[i] * r;
+    }
+}
+
+/** @brief Converts n 16-bit Qn values to float32, same as F_Qx_b16(). @note RARELY USE DIRECTLY. */
+static inline void q_b16_to_f32_c(unsigned int N, float32_t *dst, const fix16_t *src, size_t n)
+{
+    const float32_t r = Q_RECIP_F32(N);
+    for (size_t i = 0; i < n; i++)
+    {
+        dst[i] = (float32_t)src[i] * r;
+    }
+}
+
+/** @brief Converts n 32-bit Qn values to float32, same as F_Qx_b32(). @note RARELY USE DIRECTLY. */
+static inline void q_b32_to_f32_c(unsigned int N, float32_t *dst, const fix32_t *src, size_t n)
+{
+    const float32_t r = Q_RECIP_F32(N);
+    for (size_t i = 0; i < n; i++)
+    {
+        dst[i] = (float32_t)src[i] * r;
+    }
+}
+
+/** @brief Converts n 64-bit Qn values to float32, same as F_Qx_b64(). @note RARELY USE DIRECTLY. */
+static inline void q_b64_to_f32_c(unsigned int N, float32_t *dst, const fix64_t *src, size_t n)
+{
+    const float32_t r = Q_RECIP_F32(N);
+    for (size_t i = 0; i < n; i++)
+    {
+        dst[i] = (float32_t)src[i] * r;
+    }
+}
+
+/** @brief Converts n 8-bit Qn values to float64. @note RARELY USE DIRECTLY. */
+static inline void q_b08_to_f64_c(unsigned int N, float64_t *dst, const fix8_t *src, size_t n)
+{
+    const float64_t r = Q_RECIP_F64(N);
+    for (size_t i = 0; i < n; i++)
+    {
+        dst[i] = (float64_t)src[i] * r;
+    }
+}
+
+/** @brief Converts n 16-bit Qn values to float64. @note RARELY USE DIRECTLY. */
+static inline void q_b16_to_f64_c(unsigned int N, float64_t *dst, const fix16_t *src, size_t n)
+{
+    const float64_t r = Q_RECIP_F64(N);
+    for (size_t i = 0; i < n; i++)
+    {
+        dst[i] = (float64_t)src[i] * r;
+    }
+}
+
+/** @brief Converts n 32-bit Qn values to float64. @note RARELY USE DIRECTLY. */
+static inline void q_b32_to_f64_c(unsigned int N, float64_t *dst, const fix32_t *src, size_t n)
+{
+    const float64_t r = Q_RECIP_F64(N);
+    for (size_t i = 0; i < n; i++)
+    {
+        dst[i] = (float64_t)src[i] * r;
+    }
+}
+
+/** @brief Converts n 64-bit Qn values to float64. @note RARELY USE DIRECTLY. */
+static inline void q_b64_to_f64_c(unsigned int N, float64_t *dst, const fix64_t *src, size_t n)
+{
+    const float64_t r = Q_RECIP_F64(N);
+    for (size_t i = 0; i < n; i++)
+    {
+        dst[i] = (float64_t)src[i] * r;
+    }
+}
+
+
+#if Q_SIMD_SSE2
+Q_TARGET_SSE2_BEGIN
+
+static inline void q_b08_to_f32_sse2(unsigned int N, float32_t *dst, const fix8_t *src, size_t n)
+{
+    const __m128 r = _mm_set1_ps(Q_RECIP_F32(N));
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        /* Sign extend by unpacking into the high half and shifting back arithmetically. */
+        __m128i v  = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i lo = _mm_srai_epi16(_mm_unpacklo_epi8(v, v), 8);
+        __m128i hi = _mm_srai_epi16(_mm_unpackhi_epi8(v, v), 8);
+        _mm_storeu_ps(dst + i,      _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(lo, lo), 16)), r));
+        _mm_storeu_ps(dst + i +  4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(lo, lo), 16)), r));
+        _mm_storeu_ps(dst + i +  8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 16)), r));
+        _mm_storeu_ps(dst + i + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(hi, hi), 16)), r));
+    }
+    q_b08_to_f32_c(N, dst + i, src + i, n - i);
+}
+
+static inline void q_b16_to_f32_sse2(unsigned int N, float32_t *dst, const fix16_t *src, size_t n)
+{
+    const __m128 r = _mm_set1_ps(Q_RECIP_F32(N));
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+        _mm_storeu_ps(dst + i,     _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16)), r));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16)), r));
+    }
+    q_b16_to_f32_c(N, dst + i, src + i, n - i);
+}
+
+static inline void q_b32_to_f32_sse2(unsigned int N, float32_t *dst, const fix32_t *src, size_t n)
+{
+    const __m128 r = _mm_set1_ps(Q_RECIP_F32(N));
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(v), r));
+    }
+    q_b32_to_f32_c(N, dst + i, src + i, n - i);
+}
+
+Q_TARGET_END
+#endif /* Q_SIMD_SSE2 */
+
+
+#if Q_SIMD_AVX2
+Q_TARGET_AVX2_BEGIN
+
+static inline void q_b08_to_f32_avx2(unsigned int N, float32_t *dst, const fix8_t *src, size_t n)
+{
+    const __m256 r = _mm256_set1_ps(Q_RECIP_F32(N));
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m256i a = _mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i *)(src + i    )));
+        __m256i b = _mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i *)(src + i + 8)));
+        _mm256_storeu_ps(dst + i,     _mm256_mul_ps(_mm256_cvtepi32_ps(a), r));
+        _mm256_storeu_ps(dst + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(b), r));
+    }
+    q_b08_to_f32_c(N, dst + i, src + i, n - i);
+}
+
+static inline void q_b16_to_f32_avx2(unsigned int N, float32_t *dst, const fix16_t *src, size_t n)
+{
+    const __m256 r = _mm256_set1_ps(Q_RECIP_F32(N));
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m256i a = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(src + i    )));
+        __m256i b = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(src + i + 8)));
+        _mm256_storeu_ps(dst + i,     _mm256_mul_ps(_mm256_cvtepi32_ps(a), r));
+        _mm256_storeu_ps(dst + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(b), r));
+    }
+    q_b16_to_f32_c(N, dst + i, src + i, n - i);
+}
+
+static inline void q_b32_to_f32_avx2(unsigned int N, float32_t *dst, const fix32_t *src, size_t n)
+{
+    const __m256 r = _mm256_set1_ps(Q_RECIP_F32(N));
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(src + i));
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), r));
+    }
+    q_b32_to_f32_c(N, dst + i, src + i, n - i);
+}
+
+static inline void q_b08_to_f64_avx2(unsigned int N, float64_t *dst, const fix8_t *src, size_t n)
+{
+    const __m256d r = _mm256_set1_pd(Q_RECIP_F64(N));
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i v = _mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i *)(src + i)));
+        _mm256_storeu_pd(dst + i,     _mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(v)), r));
+        _mm256_storeu_pd(dst + i + 4, _mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(v, 1)), r));
+    }
+    q_b08_to_f64_c(N, dst + i, src + i, n - i);
+}
+
+static inline void q_b16_to_f64_avx2(unsigned int N, float64_t *dst, const fix16_t *src, size_t n)
+{
+    const __m256d r = _mm256_set1_pd(Q_RECIP_F64(N));
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i v = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(src + i)));
+        _mm256_storeu_pd(dst + i,     _mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(v)), r));
+        _mm256_storeu_pd(dst + i + 4, _mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(v, 1)), r));
+    }
+    q_b16_to_f64_c(N, dst + i, src + i, n - i);
+}
+
+static inline void q_b32_to_f64_avx2(unsigned int N, float64_t *dst, const fix32_t *src, size_t n)
+{
+    const __m256d r = _mm256_set1_pd(Q_RECIP_F64(N));
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+        _mm256_storeu_pd(dst + i, _mm256_mul_pd(_mm256_cvtepi32_pd(v), r));
+    }
+    q_b32_to_f64_c(N, dst + i, src + i, n - i);
+}
+
+Q_TARGET_END
+#endif /* Q_SIMD_AVX2 */
+
+
+#if Q_SIMD_AVX512
+Q_TARGET_AVX512_BEGIN
+
+static inline void q_b08_to_f32_avx512(unsigned int N, float32_t *dst, const fix8_t *src, size_t n)
+{
+    const __m512 r = _mm512_set1_ps(Q_RECIP_F32(N));
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m512i v = _mm512_cvtepi8_epi32(_mm_loadu_si128((const __m128i *)(src + i)));
+        _mm512_storeu_ps(dst + i, _mm512_mul_ps(_mm512_cvtepi32_ps(v), r));
+    }
+    q_b08_to_f32_c(N, dst + i, src + i, n - i);
+}
+
+static inline void q_b16_to_f32_avx512(unsigned int N, float32_t *dst, const fix16_t *src, size_t n)
+{
+    const __m512 r = _mm512_set1_ps(Q_RECIP_F32(N));
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m512i v = _mm512_cvtepi16_epi32(_mm256_loadu_si256((const __m256i *)(src + i)));
+        _mm512_storeu_ps(dst + i, _mm512_mul_ps(_mm512_cvtepi32_ps(v), r));
+    }
+    q_b16_to_f32_c(N, dst + i, src + i, n - i);
+}
+
+static inline void q_b32_to_f32_avx512(unsigned int N, float32_t *dst, const fix32_t *src, size_t n)
+{
+    const __m512 r = _mm512_set1_ps(Q_RECIP_F32(N));
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m512i v = _mm512_loadu_si512((const void *)(src + i));
+        _mm512_storeu_ps(dst + i, _mm512_mul_ps(_mm512_cvtepi32_ps(v), r));
+    }
+    q_b32_to_f32_c(N, dst + i, src + i, n - i);
+}
+
+static inline void q_b64_to_f32_avx512(unsigned int N, float32_t *dst, const fix64_t *src, size_t n)
+{
+    const __m256 r = _mm256_set1_ps(Q_RECIP_F32(N));
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m512i v = _mm512_loadu_si512((const void *)(src + i));
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm512_cvtepi64_ps(v), r));
+    }
+    q_b64_to_f32_c(N, dst + i, src + i, n - i);
+}
+
+static inline void q_b08_to_f64_avx512(unsigned int N, float64_t *dst, const fix8_t *src, size_t n)
+{
+    const __m512d r = _mm512_set1_pd(Q_RECIP_F64(N));
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i v = _mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i *)(src + i)));
+        _mm512_storeu_pd(dst + i, _mm512_mul_pd(_mm512_cvtepi32_pd(v), r));
+    }
+    q_b08_to_f64_c(N, dst + i, src + i, n - i);
+}
+
+static inline void q_b16_to_f64_avx512(unsigned int N, float64_t *dst, const fix16_t *src, size_t n)
+{
+    const __m512d r = _mm512_set1_pd(Q_RECIP_F64(N));
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i v = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(src + i)));
+        _mm512_storeu_pd(dst + i, _mm512_mul_pd(_mm512_cvtepi32_pd(v), r));
+    }
+    q_b16_to_f64_c(N, dst + i, src + i, n - i);
+}
+
+static inline void q_b32_to_f64_avx512(unsigned int N, float64_t *dst, const fix32_t *src, size_t n)
+{
+    const __m512d r = _mm512_set1_pd(Q_RECIP_F64(N));
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(src + i));
+        _mm512_storeu_pd(dst + i, _mm512_mul_pd(_mm512_cvtepi32_pd(v), r));
+    }
+    q_b32_to_f64_c(N, dst + i, src + i, n - i);
+}
+
+static inline void q_b64_to_f64_avx512(unsigned int N, float64_t *dst, const fix64_t *src, size_t n)
+{
+    const __m512d r = _mm512_set1_pd(Q_RECIP_F64(N));
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m512i v = _mm512_loadu_si512((const void *)(src + i));
+        _mm512_storeu_pd(dst + i, _mm512_mul_pd(_mm512_cvtepi64_pd(v), r));
+    }
+    q_b64_to_f64_c(N, dst + i, src + i, n - i);
+}
+
+Q_TARGET_END
+#endif /* Q_SIMD_AVX512 */
+
+
+// Float64-to-fixed kernels for 32 and 64 bit words, same result as Qx_b32_d()/Qx_b64_d().
+
+/** @brief Converts n float64 values to 32-bit Qn with Qx_b32_d(). @note RARELY USE DIRECTLY. */
+static inline void q_f64_to_b32_c(unsigned int N, fix32_t *dst, const float64_t *src, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        dst[i] = Qx_b32_d(N, src[i]);
+    }
+}
+
+/** @brief Converts n float64 values to 64-bit Qn with Qx_b64_d(). @note RARELY USE DIRECTLY. */
+static inline void q_f64_to_b64_c(unsigned int N, fix64_t *dst, const float64_t *src, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        dst[i] = Qx_b64_d(N, src[i]);
+    }
+}
+
+
+#if Q_SIMD_SSE2
+Q_TARGET_SSE2_BEGIN
+
+#if defined(__x86_64__) || defined(_M_X64)
+/*
+ * The ternaries in Qx_b64_d() compile to compare-and-jump, this uses the
+ * cvttsd2si overflow value instead.
+ */
+
+/** @brief Branchless Qx_b64_d(), same result. @note RARELY USE DIRECTLY. */
+static inline fix64_t q_sat_f64_to_b64(unsigned int N, float64_t x)
+{
+    __m128d s = _mm_mul_sd(_mm_set_sd(x), _mm_set_sd((float64_t)SCALE_FACTOR_64(N)));
+    /* Out of range gives 0x8000000000000000: right for the negative side, flip the positive one. */
+    int64_t ovf = -(int64_t)_mm_comige_sd(s, _mm_set_sd(9223372036854775808.0));
+    return (fix64_t)(_mm_cvttsd_si64(s) ^ ovf);
+}
+#endif
+
+static inline void q_f64_to_b32_sse2(unsigned int N, fix32_t *dst, const float64_t *src, size_t n)
+{
+    const __m128d scale = _mm_set1_pd((float64_t)SCALE_FACTOR_32(N));
+    const __m128d hi    = _mm_set1_pd((float64_t)Q_MAXb32);
+    const __m128d lo    = _mm_set1_pd((float64_t)Q_MINb32);
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128d a = _mm_mul_pd(_mm_loadu_pd(src + i    ), scale);
+        __m128d b = _mm_mul_pd(_mm_loadu_pd(src + i + 2), scale);
+        a = _mm_max_pd(_mm_min_pd(a, hi), lo);
+        b = _mm_max_pd(_mm_min_pd(b, hi), lo);
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_unpacklo_epi64(_mm_cvttpd_epi32(a), _mm_cvttpd_epi32(b)));
+    }
+    q_f64_to_b32_c(N, dst + i, src + i, n - i);
+}
+
+#if defined(__x86_64__) || defined(_M_X64)
+static inline void q_f64_to_b64_sse2(unsigned int N, fix64_t *dst, const float64_t *src, size_t n)
+{
+    /* No packed float64 to int64 before AVX512DQ, scalar but branchless. */
+    for (size_t i = 0; i < n; i++)
+    {
+        dst[i] = q_sat_f64_to_b64(N, src[i]);
+    }
+}
+#endif
+
+Q_TARGET_END
+#endif /* Q_SIMD_SSE2 */
+
+
+#if Q_SIMD_AVX2
+Q_TARGET_AVX2_BEGIN
+
+static inline void q_f64_to_b32_avx2(unsigned int N, fix32_t *dst, const float64_t *src, size_t n)
+{
+    const __m256d scale = _mm256_set1_pd((float64_t)SCALE_FACTOR_32(N));
+    const __m256d hi    = _mm256_set1_pd((float64_t)Q_MAXb32);
+    const __m256d lo    = _mm256_set1_pd((float64_t)Q_MINb32);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256d a = _mm256_mul_pd(_mm256_loadu_pd(src + i    ), scale);
+        __m256d b = _mm256_mul_pd(_mm256_loadu_pd(src + i + 4), scale);
+        a = _mm256_max_pd(_mm256_min_pd(a, hi), lo);
+        b = _mm256_max_pd(_mm256_min_pd(b, hi), lo);
+        _mm_storeu_si128((__m128i *)(dst + i    ), _mm256_cvttpd_epi32(a));
+        _mm_storeu_si128((__m128i *)(dst + i + 4), _mm256_cvttpd_epi32(b));
+    }
+    q_f64_to_b32_c(N, dst + i, src + i, n - i);
+}
+
+Q_TARGET_END
+#endif /* Q_SIMD_AVX2 */
+
+
+#if Q_SIMD_AVX512
+Q_TARGET_AVX512_BEGIN
+
+static inline void q_f64_to_b32_avx512(unsigned int N, fix32_t *dst, const float64_t *src, size_t n)
+{
+    const __m512d scale = _mm512_set1_pd((float64_t)SCALE_FACTOR_32(N));
+    const __m512d hi    = _mm512_set1_pd((float64_t)Q_MAXb32);
+    const __m512d lo    = _mm512_set1_pd((float64_t)Q_MINb32);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m512d a = _mm512_mul_pd(_mm512_loadu_pd(src + i), scale);
+        a = _mm512_max_pd(_mm512_min_pd(a, hi), lo);
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm512_cvttpd_epi32(a));
+    }
+    q_f64_to_b32_c(N, dst + i, src + i, n - i);
+}
+
+static inline void q_f64_to_b64_avx512(unsigned int N, fix64_t *dst, const float64_t *src, size_t n)
+{
+    const __m512d scale = _mm512_set1_pd((float64_t)SCALE_FACTOR_64(N));
+    const __m512d ovf   = _mm512_set1_pd(9223372036854775808.0);
+    const __m512i qmax  = _mm512_set1_epi64(Q_MAXb64);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m512d  a = _mm512_mul_pd(_mm512_loadu_pd(src + i), scale);
+        __mmask8 m = _mm512_cmp_pd_mask(a, ovf, _CMP_GE_OQ);
+        _mm512_storeu_si512((void *)(dst + i), _mm512_mask_mov_epi64(_mm512_cvttpd_epi64(a), m, qmax));
+    }
+    q_f64_to_b64_c(N, dst + i, src + i, n - i);
+}
+
+Q_TARGET_END
+#endif /* Q_SIMD_AVX512 */
+
+
+// Kernel table, bound once per translation unit to the tier from q_isa().
+
+typedef struct
+{
+    void (*f32_to_b08)(unsigned int N, fix8_t  *dst, const float32_t *src, size_t n);
+    void (*f32_to_b16)(unsigned int N, fix16_t *dst, const float32_t *src, size_t n);
+    void (*f32_to_b32)(unsigned int N, fix32_t *dst, const float32_t *src, size_t n);
+    void (*f32_to_b64)(unsigned int N, fix64_t *dst, const float32_t *src, size_t n);
+    void (*f64_to_b32)(unsigned int N, fix32_t *dst, const float64_t *src, size_t n);
+    void (*f64_to_b64)(unsigned int N, fix64_t *dst, const float64_t *src, size_t n);
+    void (*b08_to_f32)(unsigned int N, float32_t *dst, const fix8_t  *src, size_t n);
+    void (*b16_to_f32)(unsigned int N, float32_t *dst, const fix16_t *src, size_t n);
+    void (*b32_to_f32)(unsigned int N, float32_t *dst, const fix32_t *src, size_t n);
+    void (*b64_to_f32)(unsigned int N, float32_t *dst, const fix64_t *src, size_t n);
+    void (*b08_to_f64)(unsigned int N, float64_t *dst, const fix8_t  *src, size_t n);
+    void (*b16_to_f64)(unsigned int N, float64_t *dst, const fix16_t *src, size_t n);
+    void (*b32_to_f64)(unsigned int N, float64_t *dst, const fix32_t *src, size_t n);
+    void (*b64_to_f64)(unsigned int N, float64_t *dst, const fix64_t *src, size_t n);
+    int    bound;
+} q_array_fn_t;
+
+static q_array_fn_t q_array_k;
+
+#ifdef Q_SAT_COUNT
+static q_array_fn_t q_array_raw;    /* Kernels behind the counting wrappers, see q_sat.h. */
+
+Q_SAT_WRAP(q_f32_to_b08_sat,  8, fix8_t,  float32_t, q_sat_f32, q_array_raw.f32_to_b08)
+Q_SAT_WRAP(q_f32_to_b16_sat, 16, fix16_t, float32_t, q_sat_f32, q_array_raw.f32_to_b16)
+Q_SAT_WRAP(q_f32_to_b32_sat, 32, fix32_t, float32_t, q_sat_f32, q_array_raw.f32_to_b32)
+Q_SAT_WRAP(q_f32_to_b64_sat, 64, fix64_t, float32_t, q_sat_f32, q_array_raw.f32_to_b64)
+Q_SAT_WRAP(q_f64_to_b32_sat, 32, fix32_t, float64_t, q_sat_f64, q_array_raw.f64_to_b32)
+Q_SAT_WRAP(q_f64_to_b64_sat, 64, fix64_t, float64_t, q_sat_f64, q_array_raw.f64_to_b64)
+#endif
+
+/** @brief Fills q_array_k for q_isa(). Runs before main() where supported. @note RARELY USE DIRECTLY. */
+static Q_CONSTRUCTOR void q_array_bind(void)
+{
+    q_isa_t      isa = q_isa();
+    q_array_fn_t k   =
+    {
+        q_f32_to_b08_c, q_f32_to_b16_c, q_f32_to_b32_c, q_f32_to_b64_c,
+        q_f64_to_b32_c, q_f64_to_b64_c,
+        q_b08_to_f32_c, q_b16_to_f32_c, q_b32_to_f32_c, q_b64_to_f32_c,
+        q_b08_to_f64_c, q_b16_to_f64_c, q_b32_to_f64_c, q_b64_to_f64_c,
+        1
+    };
+
+    (void)isa;
+#if Q_SIMD_SSE2
+    if (isa >= Q_ISA_SSE2)
+    {
+        k.f32_to_b08 = q_f32_to_b08_sse2;
+        k.f32_to_b16 = q_f32_to_b16_sse2;
+        k.f32_to_b32 = q_f32_to_b32_sse2;
+        k.f64_to_b32 = q_f64_to_b32_sse2;
+#if defined(__x86_64__) || defined(_M_X64)
+        k.f64_to_b64 = q_f64_to_b64_sse2;
+#endif
+        k.b08_to_f32 = q_b08_to_f32_sse2;
+        k.b16_to_f32 = q_b16_to_f32_sse2;
+        k.b32_to_f32 = q_b32_to_f32_sse2;
+    }
+#endif
+#if Q_SIMD_AVX2
+    if (isa >= Q_ISA_AVX2)
+    {
+        k.f32_to_b08 = q_f32_to_b08_avx2;
+        k.f32_to_b16 = q_f32_to_b16_avx2;
+        k.f32_to_b32 = q_f32_to_b32_avx2;
+        k.f64_to_b32 = q_f64_to_b32_avx2;
+        k.b08_to_f32 = q_b08_to_f32_avx2;
+        k.b16_to_f32 = q_b16_to_f32_avx2;
+        k.b32_to_f32 = q_b32_to_f32_avx2;
+        k.b08_to_f64 = q_b08_to_f64_avx2;
+        k.b16_to_f64 = q_b16_to_f64_avx2;
+        k.b32_to_f64 = q_b32_to_f64_avx2;
+    }
+#endif
+#if Q_SIMD_AVX512
+    if (isa >= Q_ISA_AVX512)
+    {
+        k.f32_to_b08 = q_f32_to_b08_avx512;
+        k.f32_to_b16 = q_f32_to_b16_avx512;
+        k.f32_to_b32 = q_f32_to_b32_avx512;
+        k.f32_to_b64 = q_f32_to_b64_avx512;
+        k.f64_to_b32 = q_f64_to_b32_avx512;
+        k.f64_to_b64 = q_f64_to_b64_avx512;
+        k.b08_to_f32 = q_b08_to_f32_avx512;
+        k.b16_to_f32 = q_b16_to_f32_avx512;
+        k.b32_to_f32 = q_b32_to_f32_avx512;
+        k.b64_to_f32 = q_b64_to_f32_avx512;
+        k.b08_to_f64 = q_b08_to_f64_avx512;
+        k.b16_to_f64 = q_b16_to_f64_avx512;
+        k.b32_to_f64 = q_b32_to_f64_avx512;
+        k.b64_to_f64 = q_b64_to_f64_avx512;
+    }
+#endif
+#ifdef Q_SAT_COUNT
+    q_array_raw  = k;
+    k.f32_to_b08 = q_f32_to_b08_sat;
+    k.f32_to_b16 = q_f32_to_b16_sat;
+    k.f32_to_b32 = q_f32_to_b32_sat;
+    k.f32_to_b64 = q_f32_to_b64_sat;
+    k.f64_to_b32 = q_f64_to_b32_sat;
+    k.f64_to_b64 = q_f64_to_b64_sat;
+#endif
+    q_array_k = k;
+}
+
+/** @brief Bound kernel table. Binds on first use if the constructor has not run yet. @note RARELY USE DIRECTLY. */
+static inline const q_array_fn_t *q_array_fn(void)
+{
+    if (!q_array_k.bound)
+    {
+        q_array_bind();
+    }
+    return &q_array_k;
+}
+
+
+// Use this!
+
+/** @brief Converts n float32 values to 8-bit Qn, same as Qx_b08() per element. */
+static inline void Qx_b08_array(unsigned int N, fix8_t *dst, const float32_t *src, size_t n)
+{
+    q_array_fn()->f32_to_b08(N, dst, src, n);
+}
+
+/** @brief Converts n float32 values to 16-bit Qn, same as Qx_b16() per element. */
+static inline void Qx_b16_array(unsigned int N, fix16_t *dst, const float32_t *src, size_t n)
+{
+    q_array_fn()->f32_to_b16(N, dst, src, n);
+}
+
+/** @brief Converts n float32 values to 32-bit Qn, same as Qx_b32() per element. */
+static inline void Qx_b32_array(unsigned int N, fix32_t *dst, const float32_t *src, size_t n)
+{
+    q_array_fn()->f32_to_b32(N, dst, src, n);
+}
+
+/** @brief Converts n float32 values to 64-bit Qn, same as Qx_b64() per element.
+ *  @note  Vectorized with AVX-512 only, float32 to int64 needs AVX512DQ. */
+static inline void Qx_b64_array(unsigned int N, fix64_t *dst, const float32_t *src, size_t n)
+{
+    q_array_fn()->f32_to_b64(N, dst, src, n);
+}
+
+// Most used formats.
+#define Q7_b8_array(dst, src, n)    Qx_b08_array( 7, dst, src, n) /**< Converts float array to 8-bit Q7. */
+#define Q6_b8_array(dst, src, n)    Qx_b08_array( 6, dst, src, n) /**< Converts float array to 8-bit Q6. */
+#define Q15_b16_array(dst, src, n)  Qx_b16_array(15, dst, src, n) /**< Converts float array to 16-bit Q15. */
+#define Q14_b16_array(dst, src, n)  Qx_b16_array(14, dst, src, n) /**< Converts float array to 16-bit Q14. */
+#define Q31_b32_array(dst, src, n)  Qx_b32_array(31, dst, src, n) /**< Converts float array to 32-bit Q31. */
+#define Q30_b32_array(dst, src, n)  Qx_b32_array(30, dst, src, n) /**< Converts float array to 32-bit Q30. */
+#define Q63_b64_array(dst, src, n)  Qx_b64_array(63, dst, src, n) /**< Converts float array to 64-bit Q63. */
+#define Q62_b64_array(dst, src, n)  Qx_b64_array(62, dst, src, n) /**< Converts float array to 64-bit Q62. */
+
+
+/** @brief Converts n float64 values to 32-bit Qn, same as Qx_b32_d() per element. */
+static inline void Qx_b32_array_d(unsigned int N, fix32_t *dst, const float64_t *src, size_t n)
+{
+    q_array_fn()->f64_to_b32(N, dst, src, n);
+}
+
+/** @brief Converts n float64 values to 64-bit Qn, same as Qx_b64_d() per element.
+ *  @note  Vectorized with AVX-512 only, float64 to int64 needs AVX512DQ. */
+static inline void Qx_b64_array_d(unsigned int N, fix64_t *dst, const float64_t *src, size_t n)
+{
+    q_array_fn()->f64_to_b64(N, dst, src, n);
+}
+
+/** @brief Converts n 8-bit Qn values to float32, same as F_Qx_b08() per element. */
+static inline void F_Qx_b08_array(unsigned int N, float32_t *dst, const fix8_t *src, size_t n)
+{
+    q_array_fn()->b08_to_f32(N, dst, src, n);
+}
+
+/** @brief Converts n 16-bit Qn values to float32, same as F_Qx_b16() per element. */
+static inline void F_Qx_b16_array(unsigned int N, float32_t *dst, const fix16_t *src, size_t n)
+{
+    q_array_fn()->b16_to_f32(N, dst, src, n);
+}
+
+/** @brief Converts n 32-bit Qn values to float32, same as F_Qx_b32() per element. */
+static inline void F_Qx_b32_array(unsigned int N, float32_t *dst, const fix32_t *src, size_t n)
+{
+    q_array_fn()->b32_to_f32(N, dst, src, n);
+}
+
+/** @brief Converts n 64-bit Qn values to float32, same as F_Qx_b64() per element.
+ *  @note  Vectorized with AVX-512 only, int64 to float32 needs AVX512DQ. */
+static inline void F_Qx_b64_array(unsigned int N, float32_t *dst, const fix64_t *src, size_t n)
+{
+    q_array_fn()->b64_to_f32(N, dst, src, n);
+}
+
+/** @brief Converts n 8-bit Qn values to float64 (exact). */
+static inline void F_Qx_b08_array_d(unsigned int N, float64_t *dst, const fix8_t *src, size_t n)
+{
+    q_array_fn()->b08_to_f64(N, dst, src, n);
+}
+
+/** @brief Converts n 16-bit Qn values to float64 (exact). */
+static inline void F_Qx_b16_array_d(unsigned int N, float64_t *dst, const fix16_t *src, size_t n)
+{
+    q_array_fn()->b16_to_f64(N, dst, src, n);
+}
+
+/** @brief Converts n 32-bit Qn values to float64 (exact), same as F_Qx_b32_d() per element. */
+static inline void F_Qx_b32_array_d(unsigned int N, float64_t *dst, const fix32_t *src, size_t n)
+{
+    q_array_fn()->b32_to_f64(N, dst, src, n);
+}
+
+/** @brief Converts n 64-bit Qn values to float64 (rounded to 53 bits), same as F_Qx_b64_d() per element.
+ *  @note  Vectorized with AVX-512 only, int64 to float64 needs AVX512DQ. */
+static inline void F_Qx_b64_array_d(unsigned int N, float64_t *dst, const fix64_t *src, size_t n)
+{
+    q_array_fn()->b64_to_f64(N, dst, src, n);
+}
+
+// Most used formats.
+#define F_Q7b8_array(dst, src, n)   F_Qx_b08_array( 7, dst, src, n) /**< Converts 8-bit Q7 array to float. */
+#define F_Q6b8_array(dst, src, n)   F_Qx_b08_array( 6, dst, src, n) /**< Converts 8-bit Q6 array to float. */
+#define F_Q15b16_array(dst, src, n) F_Qx_b16_array(15, dst, src, n) /**< Converts 16-bit Q15 array to float. */
+#define F_Q14b16_array(dst, src, n) F_Qx_b16_array(14, dst, src, n) /**< Converts 16-bit Q14 array to float. */
+#define F_Q31b32_array(dst, src, n) F_Qx_b32_array(31, dst, src, n) /**< Converts 32-bit Q31 array to float. */
+#define F_Q30b32_array(dst, src, n) F_Qx_b32_array(30, dst, src, n) /**< Converts 32-bit Q30 array to float. */
+#define F_Q63b64_array(dst, src, n) F_Qx_b64_array(63, dst, src, n) /**< Converts 64-bit Q63 array to float. */
+#define F_Q62b64_array(dst, src, n) F_Qx_b64_array(62, dst, src, n) /**< Converts 64-bit Q62 array to float. */
+
+
+#endif /* SRC_Q_ARRAY_H_ */
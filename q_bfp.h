@@ -0,0 +1,296 @@
+/**
+ * @file    q_bfp.h
+ * @brief   Block floating point: float32 to 8, 16 or 32 bit mantissas with
+ *          one Q format per block, picked from the data.
+ *
+ *          Each block of `block` samples gets the largest N in 0 .. W-1 with
+ *          max |x| < F_MAXbxx(N), so nothing saturates unless even N = 0
+ *          does. N is stored as one byte per block, the mantissas are plain
+ *          Qx_bxx(N, x) words, and the decoder is F_Qx_bxx(N, q) per block;
+ *          both go through the q_array.h kernels and give the same bits.
+ *
+ *          @code
+ *          fix8_t  mant[4096];
+ *          uint8_t exp[Q_BFP_BLOCKS(4096, 64)];        // 64 blocks
+ *          Qx_b08_bfp(mant, exp, samples, 4096, 64);   // 4160 bytes instead of 16384
+ *          F_Qx_b08_bfp(samples, mant, exp, 4096, 64);
+ *          @endcode
+ *
+ *          The max |x| scan is vectorized (SSE2/AVX2/AVX-512) and compares
+ *          the float bits as integers, so it is one integer max per vector.
+ *
+ * @note    Blocks whose values are all below 2^-(W-1) in magnitude still
+ *          use N = W-1, they lose precision like Qx_bxx(W-1, x) would.
+ * @note    block must be at least 1; with block == 0 the functions return
+ *          without touching dst or exp. The last block may be shorter than
+ *          `block`. NaN input is undefined, same as with the scalar macros.
+ */
+
+#ifndef SRC_Q_BFP_H_
+#define SRC_Q_BFP_H_
+
+
+#include "q_array.h"
+#include "q_macros.h"
+#include "q_simd.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/** @brief Number of blocks, i.e. exponent bytes, for n samples. */
+#define Q_BFP_BLOCKS(n, block)      ( ((n) + (block) - 1) / (block) )
+
+
+// Plain C kernels
+
+/** @brief Largest |src[i]| as float bits (sign cleared). @note RARELY USE DIRECTLY. */
+static inline uint32_t q_bfp_maxabs_c(const float32_t *src, size_t n)
+{
+    uint32_t m = 0;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        uint32_t u;
+        memcpy(&u, src + i, sizeof(u));
+        u &= 0x7FFFFFFFU;
+        m = u > m ? u : m;
+    }
+    return m;
+}
+
+
+/*
+ * With the sign cleared, float bits order like the values, so the scan is a
+ * signed 32-bit integer max (every pattern is non-negative).
+ */
+
+#if Q_SIMD_SSE2
+Q_TARGET_SSE2_BEGIN
+
+static inline uint32_t q_bfp_maxabs_sse2(const float32_t *src, size_t n)
+{
+    const __m128i abs = _mm_set1_epi32(0x7FFFFFFF);
+    __m128i       m   = _mm_setzero_si128();
+    uint32_t      r[4];
+    size_t        i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128i u  = _mm_and_si128(_mm_loadu_si128((const __m128i *)(src + i)), abs);
+        __m128i gt = _mm_cmpgt_epi32(u, m);
+        m = _mm_or_si128(_mm_and_si128(gt, u), _mm_andnot_si128(gt, m));
+    }
+    _mm_storeu_si128((__m128i *)r, m);
+    r[0] = r[0] > r[1] ? r[0] : r[1];
+    r[2] = r[2] > r[3] ? r[2] : r[3];
+    r[0] = r[0] > r[2] ? r[0] : r[2];
+    r[1] = q_bfp_maxabs_c(src + i, n - i);
+    return r[0] > r[1] ? r[0] : r[1];
+}
+
+Q_TARGET_END
+#endif /* Q_SIMD_SSE2 */
+
+
+#if Q_SIMD_AVX2
+Q_TARGET_AVX2_BEGIN
+
+static inline uint32_t q_bfp_maxabs_avx2(const float32_t *src, size_t n)
+{
+    const __m256i abs = _mm256_set1_epi32(0x7FFFFFFF);
+    __m256i       m0  = _mm256_setzero_si256();
+    __m256i       m1  = _mm256_setzero_si256();
+    __m128i       m;
+    uint32_t      a, b;
+    size_t        i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        m0 = _mm256_max_epi32(m0, _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(src + i)), abs));
+        m1 = _mm256_max_epi32(m1, _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(src + i + 8)), abs));
+    }
+    m0 = _mm256_max_epi32(m0, m1);
+    m  = _mm_max_epi32(_mm256_castsi256_si128(m0), _mm256_extracti128_si256(m0, 1));
+    m  = _mm_max_epi32(m, _mm_shuffle_epi32(m, 0x4E));
+    m  = _mm_max_epi32(m, _mm_shuffle_epi32(m, 0xB1));
+    a  = (uint32_t)_mm_cvtsi128_si32(m);
+    b  = q_bfp_maxabs_c(src + i, n - i);
+    return a > b ? a : b;
+}
+
+Q_TARGET_END
+#endif /* Q_SIMD_AVX2 */
+
+
+#if Q_SIMD_AVX512
+Q_TARGET_AVX512_BEGIN
+
+static inline uint32_t q_bfp_maxabs_avx512(const float32_t *src, size_t n)
+{
+    const __m512i abs = _mm512_set1_epi32(0x7FFFFFFF);
+    __m512i       m   = _mm512_setzero_si512();
+    uint32_t      a, b;
+    size_t        i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        m = _mm512_max_epi32(m, _mm512_and_si512(_mm512_loadu_si512((const void *)(src + i)), abs));
+    }
+    a = (uint32_t)_mm512_reduce_max_epi32(m);
+    b = q_bfp_maxabs_c(src + i, n - i);
+    return a > b ? a : b;
+}
+
+Q_TARGET_END
+#endif /* Q_SIMD_AVX512 */
+
+
+// Kernel table, bound once per translation unit to the tier from q_isa().
+
+typedef struct
+{
+    uint32_t (*maxabs)(const float32_t *src, size_t n);
+    int        bound;
+} q_bfp_fn_t;
+
+static q_bfp_fn_t q_bfp_k;
+
+/** @brief Fills q_bfp_k for q_isa(). Runs before main() where supported. @note RARELY USE DIRECTLY. */
+static Q_CONSTRUCTOR void q_bfp_bind(void)
+{
+    q_isa_t    isa = q_isa();
+    q_bfp_fn_t k   = { q_bfp_maxabs_c, 1 };
+
+    (void)isa;
+#if Q_SIMD_SSE2
+    if (isa >= Q_ISA_SSE2)
+    {
+        k.maxabs = q_bfp_maxabs_sse2;
+    }
+#endif
+#if Q_SIMD_AVX2
+    if (isa >= Q_ISA_AVX2)
+    {
+        k.maxabs = q_bfp_maxabs_avx2;
+    }
+#endif
+#if Q_SIMD_AVX512
+    if (isa >= Q_ISA_AVX512)
+    {
+        k.maxabs = q_bfp_maxabs_avx512;
+    }
+#endif
+    q_bfp_k = k;
+}
+
+/** @brief Bound kernel table. Binds on first use if the constructor has not run yet. @note RARELY USE DIRECTLY. */
+static inline const q_bfp_fn_t *q_bfp_fn(void)
+{
+    if (!q_bfp_k.bound)
+    {
+        q_bfp_bind();
+    }
+    return &q_bfp_k;
+}
+
+/**
+ * @brief Largest N in 0 .. W-1 with max |x| < F_MAXbxx(N) for a block. @note RARELY USE DIRECTLY.
+ *
+ * max |x| has float exponent field e, so it is below 2^(e-126); that is under
+ * 2^(W-1-N) for N <= W+125-e. Zero and subnormals give W-1, Inf gives 0.
+ */
+static inline unsigned int q_bfp_n(unsigned int W, const float32_t *src, size_t n)
+{
+    int N = (int)W + 125 - (int)(q_bfp_fn()->maxabs(src, n) >> 23);
+    return N < 0 ? 0U : (N > (int)W - 1 ? W - 1 : (unsigned int)N);
+}
+
+
+// Use this!
+
+/** @brief Block floating point encode to 8-bit mantissas, one N per block in exp[Q_BFP_BLOCKS(n, block)]. */
+static inline void Qx_b08_bfp(fix8_t *dst, uint8_t *exp, const float32_t *src, size_t n, size_t block)
+{
+    if (block == 0)
+    {
+        return;
+    }
+    for (size_t i = 0; i < n; i += block, exp++)
+    {
+        size_t m = n - i < block ? n - i : block;
+        *exp = (uint8_t)q_bfp_n(8, src + i, m);
+        Qx_b08_array(*exp, dst + i, src + i, m);
+    }
+}
+
+/** @brief Block floating point encode to 16-bit mantissas, one N per block in exp[Q_BFP_BLOCKS(n, block)]. */
+static inline void Qx_b16_bfp(fix16_t *dst, uint8_t *exp, const float32_t *src, size_t n, size_t block)
+{
+    if (block == 0)
+    {
+        return;
+    }
+    for (size_t i = 0; i < n; i += block, exp++)
+    {
+        size_t m = n - i < block ? n - i : block;
+        *exp = (uint8_t)q_bfp_n(16, src + i, m);
+        Qx_b16_array(*exp, dst + i, src + i, m);
+    }
+}
+
+/** @brief Block floating point encode to 32-bit mantissas, one N per block in exp[Q_BFP_BLOCKS(n, block)]. */
+static inline void Qx_b32_bfp(fix32_t *dst, uint8_t *exp, const float32_t *src, size_t n, size_t block)
+{
+    if (block == 0)
+    {
+        return;
+    }
+    for (size_t i = 0; i < n; i += block, exp++)
+    {
+        size_t m = n - i < block ? n - i : block;
+        *exp = (uint8_t)q_bfp_n(32, src + i, m);
+        Qx_b32_array(*exp, dst + i, src + i, m);
+    }
+}
+
+/** @brief Block floating point decode of 8-bit mantissas, inverse of Qx_b08_bfp(). */
+static inline void F_Qx_b08_bfp(float32_t *dst, const fix8_t *src, const uint8_t *exp, size_t n, size_t block)
+{
+    if (block == 0)
+    {
+        return;
+    }
+    for (size_t i = 0; i < n; i += block, exp++)
+    {
+        F_Qx_b08_array(*exp, dst + i, src + i, n - i < block ? n - i : block);
+    }
+}
+
+/** @brief Block floating point decode of 16-bit mantissas, inverse of Qx_b16_bfp(). */
+static inline void F_Qx_b16_bfp(float32_t *dst, const fix16_t *src, const uint8_t *exp, size_t n, size_t block)
+{
+    if (block == 0)
+    {
+        return;
+    }
+    for (size_t i = 0; i < n; i += block, exp++)
+    {
+        F_Qx_b16_array(*exp, dst + i, src + i, n - i < block ? n - i : block);
+    }
+}
+
+/** @brief Block floating point decode of 32-bit mantissas, inverse of Qx_b32_bfp(). */
+static inline void F_Qx_b32_bfp(float32_t *dst, const fix32_t *src, const uint8_t *exp, size_t n, size_t block)
+{
+    if (block == 0)
+    {
+        return;
+    }
+    for (size_t i = 0; i < n; i += block, exp++)
+    {
+        F_Qx_b32_array(*exp, dst + i, src + i, n - i < block ? n - i : block);
+    }
+}
+
+
+#endif /* SRC_Q_BFP_H_ */
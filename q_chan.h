@@ -0,0 +1,609 @@
+/**
+ * @file    q_chan.h
+ * @brief   Strided, interleaved and multichannel array conversion for 16 and
+ *          32 bit words, each channel in its own Q format.
+ *
+ *          Channel formats come as an array N[C]; frame f of an interleaved
+ *          buffer is elements f*C .. f*C + C-1 (C = 2 for I/Q).
+ *          - Qx_bxx_array_ch(N, C, dst, src, frames): interleaved floats to
+ *            interleaved words, element f*C + c with Qx_bxx(N[c], x).
+ *          - Qx_bxx_deinterleave(N, C, dst[C], src, frames): interleaved
+ *            floats to one word array per channel.
+ *          - Qx_bxx_interleave(N, C, dst, src[C], frames): one float array
+ *            per channel to interleaved words.
+ *          - F_Qx_bxx_...: the same three, words to floats.
+ *          - Qx_bxx_array_s(N, dst, dst_stride, src, src_stride, n) and
+ *            F_Qx_bxx_array_s(): one format, any strides (in elements,
+ *            negative allowed). Plain C loops.
+ *
+ *          Results are those of Qx_bxx() / F_Qx_bxx() per element. The
+ *          interleaved kernels (SSE2, AVX2, AVX-512) scale by a vector of
+ *          per-lane 2^N that repeats every C vectors, so they cost the same as
+ *          Qx_bxx_array(). Deinterleave and interleave convert Q_CHAN_BLOCK
+ *          elements at a time through such a kernel and move the words in an
+ *          L1 buffer; the data is read and written once.
+ *
+ *          @code
+ *          const unsigned int iq[2] = { 15, 15 };
+ *          Qx_b16_array_ch(iq, 2, out, rx, frames);            // I/Q floats to I/Q Q15
+ *          const unsigned int fmt[3] = { 15, 12, 12 };
+ *          fix16_t *ch[3] = { ref, mic1, mic2 };
+ *          Qx_b16_deinterleave(fmt, 3, ch, pcm, frames);       // 3 channels, own N each
+ *          @endcode
+ *
+ * @note    More than Q_CHAN_MAX channels run the plain C loops.
+ */
+
+#ifndef SRC_Q_CHAN_H_
+#define SRC_Q_CHAN_H_
+
+
+#include "q_array.h"
+#include "q_macros.h"
+#include "q_simd.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef Q_CHAN_MAX
+#define Q_CHAN_MAX      32U         /**< Most channels the SIMD kernels take. */
+#endif
+
+#ifndef Q_CHAN_BLOCK
+#define Q_CHAN_BLOCK    1024U       /**< Elements per (de)interleave step, buffer on the stack. Multiple of Q_CHAN_MAX. */
+#endif
+
+
+// Plain C kernels, reference for all others. Element i is channel (c + i) % C, c < C.
+
+static inline void q_f32_to_b16_ch_c(const unsigned int *N, size_t C, size_t c, fix16_t *dst, const float32_t *src, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        dst[i] = Qx_b16(N[c], src[i]);
+        c = c + 1 == C ? 0 : c + 1;
+    }
+}
+
+static inline void q_f32_to_b32_ch_c(const unsigned int *N, size_t C, size_t c, fix32_t *dst, const float32_t *src, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        dst[i] = Qx_b32(N[c], src[i]);
+        c = c + 1 == C ? 0 : c + 1;
+    }
+}
+
+static inline void q_b16_to_f32_ch_c(const unsigned int *N, size_t C, size_t c, float32_t *dst, const fix16_t *src, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        dst[i] = F_Qx_b16(N[c], src[i]);
+        c = c + 1 == C ? 0 : c + 1;
+    }
+}
+
+static inline void q_b32_to_f32_ch_c(const unsigned int *N, size_t C, size_t c, float32_t *dst, const fix32_t *src, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        dst[i] = F_Qx_b32(N[c], src[i]);
+        c = c + 1 == C ? 0 : c + 1;
+    }
+}
+
+/**
+ * @brief Per-lane scales for `lanes`-wide vectors: pat[j] is 2^N (or 2^-N with recip) of
+ *        channel (c + j) % C, for C vectors, after which the pattern repeats. @note RARELY USE DIRECTLY.
+ */
+static inline void q_chan_pat(float32_t *pat, size_t lanes, const unsigned int *N, size_t C, size_t c, int recip)
+{
+    for (size_t j = 0; j < lanes * C; j++)
+    {
+        pat[j] = recip ? Q_RECIP_F32(N[c]) : (float32_t)SCALE_FACTOR_64(N[c]);
+        c = c + 1 == C ? 0 : c + 1;
+    }
+}
+
+
+/*
+ * Same scheme as the q_array.h kernels (clamp and pack for 16 bit, overflow
+ * compare for 32 bit); only the scale is a vector loaded from the pattern,
+ * stepping through its C vectors.
+ */
+
+#if Q_SIMD_SSE2
+Q_TARGET_SSE2_BEGIN
+
+static inline void q_f32_to_b16_ch_sse2(const unsigned int *N, size_t C, size_t c, fix16_t *dst, const float32_t *src, size_t n)
+{
+    const __m128 hi = _mm_set1_ps((float32_t)Q_MAXb16);
+    const __m128 lo = _mm_set1_ps((float32_t)Q_MINb16);
+    float32_t    pat[4 * Q_CHAN_MAX];
+    size_t       i = 0, p = 0;
+
+    if (C > Q_CHAN_MAX)
+    {
+        q_f32_to_b16_ch_c(N, C, c, dst, src, n);
+        return;
+    }
+    q_chan_pat(pat, 4, N, C, c, 0);
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128 a = _mm_mul_ps(_mm_loadu_ps(src + i), _mm_loadu_ps(pat + 4 * p));
+        p = p + 1 == C ? 0 : p + 1;
+        __m128 b = _mm_mul_ps(_mm_loadu_ps(src + i + 4), _mm_loadu_ps(pat + 4 * p));
+        p = p + 1 == C ? 0 : p + 1;
+        a = _mm_max_ps(_mm_min_ps(a, hi), lo);
+        b = _mm_max_ps(_mm_min_ps(b, hi), lo);
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_packs_epi32(_mm_cvttps_epi32(a), _mm_cvttps_epi32(b)));
+    }
+    q_f32_to_b16_ch_c(N, C, (c + i) % C, dst + i, src + i, n - i);
+}
+
+static inline void q_f32_to_b32_ch_sse2(const unsigned int *N, size_t C, size_t c, fix32_t *dst, const float32_t *src, size_t n)
+{
+    const __m128 ovf = _mm_set1_ps(2147483648.0f);
+    float32_t    pat[4 * Q_CHAN_MAX];
+    size_t       i = 0, p = 0;
+
+    if (C > Q_CHAN_MAX)
+    {
+        q_f32_to_b32_ch_c(N, C, c, dst, src, n);
+        return;
+    }
+    q_chan_pat(pat, 4, N, C, c, 0);
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128  a = _mm_mul_ps(_mm_loadu_ps(src + i), _mm_loadu_ps(pat + 4 * p));
+        __m128i m = _mm_castps_si128(_mm_cmpge_ps(a, ovf));
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_xor_si128(_mm_cvttps_epi32(a), m));
+        p = p + 1 == C ? 0 : p + 1;
+    }
+    q_f32_to_b32_ch_c(N, C, (c + i) % C, dst + i, src + i, n - i);
+}
+
+static inline void q_b16_to_f32_ch_sse2(const unsigned int *N, size_t C, size_t c, float32_t *dst, const fix16_t *src, size_t n)
+{
+    float32_t pat[4 * Q_CHAN_MAX];
+    size_t    i = 0, p = 0;
+
+    if (C > Q_CHAN_MAX)
+    {
+        q_b16_to_f32_ch_c(N, C, c, dst, src, n);
+        return;
+    }
+    q_chan_pat(pat, 4, N, C, c, 1);
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i a = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        __m128i b = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(a), _mm_loadu_ps(pat + 4 * p)));
+        p = p + 1 == C ? 0 : p + 1;
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(b), _mm_loadu_ps(pat + 4 * p)));
+        p = p + 1 == C ? 0 : p + 1;
+    }
+    q_b16_to_f32_ch_c(N, C, (c + i) % C, dst + i, src + i, n - i);
+}
+
+static inline void q_b32_to_f32_ch_sse2(const unsigned int *N, size_t C, size_t c, float32_t *dst, const fix32_t *src, size_t n)
+{
+    float32_t pat[4 * Q_CHAN_MAX];
+    size_t    i = 0, p = 0;
+
+    if (C > Q_CHAN_MAX)
+    {
+        q_b32_to_f32_ch_c(N, C, c, dst, src, n);
+        return;
+    }
+    q_chan_pat(pat, 4, N, C, c, 1);
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(v), _mm_loadu_ps(pat + 4 * p)));
+        p = p + 1 == C ? 0 : p + 1;
+    }
+    q_b32_to_f32_ch_c(N, C, (c + i) % C, dst + i, src + i, n - i);
+}
+
+Q_TARGET_END
+#endif /* Q_SIMD_SSE2 */
+
+
+#if Q_SIMD_AVX2
+Q_TARGET_AVX2_BEGIN
+
+static inline void q_f32_to_b16_ch_avx2(const unsigned int *N, size_t C, size_t c, fix16_t *dst, const float32_t *src, size_t n)
+{
+    const __m256 hi = _mm256_set1_ps((float32_t)Q_MAXb16);
+    const __m256 lo = _mm256_set1_ps((float32_t)Q_MINb16);
+    float32_t    pat[8 * Q_CHAN_MAX];
+    size_t       i = 0, p = 0;
+
+    if (C > Q_CHAN_MAX)
+    {
+        q_f32_to_b16_ch_c(N, C, c, dst, src, n);
+        return;
+    }
+    q_chan_pat(pat, 8, N, C, c, 0);
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256  a = _mm256_mul_ps(_mm256_loadu_ps(src + i), _mm256_loadu_ps(pat + 8 * p));
+        __m256i q = _mm256_cvttps_epi32(_mm256_max_ps(_mm256_min_ps(a, hi), lo));
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_packs_epi32(_mm256_castsi256_si128(q), _mm256_extracti128_si256(q, 1)));
+        p = p + 1 == C ? 0 : p + 1;
+    }
+    q_f32_to_b16_ch_c(N, C, (c + i) % C, dst + i, src + i, n - i);
+}
+
+static inline void q_f32_to_b32_ch_avx2(const unsigned int *N, size_t C, size_t c, fix32_t *dst, const float32_t *src, size_t n)
+{
+    const __m256 ovf = _mm256_set1_ps(2147483648.0f);
+    float32_t    pat[8 * Q_CHAN_MAX];
+    size_t       i = 0, p = 0;
+
+    if (C > Q_CHAN_MAX)
+    {
+        q_f32_to_b32_ch_c(N, C, c, dst, src, n);
+        return;
+    }
+    q_chan_pat(pat, 8, N, C, c, 0);
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256  a = _mm256_mul_ps(_mm256_loadu_ps(src + i), _mm256_loadu_ps(pat + 8 * p));
+        __m256i m = _mm256_castps_si256(_mm256_cmp_ps(a, ovf, _CMP_GE_OQ));
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_xor_si256(_mm256_cvttps_epi32(a), m));
+        p = p + 1 == C ? 0 : p + 1;
+    }
+    q_f32_to_b32_ch_c(N, C, (c + i) % C, dst + i, src + i, n - i);
+}
+
+static inline void q_b16_to_f32_ch_avx2(const unsigned int *N, size_t C, size_t c, float32_t *dst, const fix16_t *src, size_t n)
+{
+    float32_t pat[8 * Q_CHAN_MAX];
+    size_t    i = 0, p = 0;
+
+    if (C > Q_CHAN_MAX)
+    {
+        q_b16_to_f32_ch_c(N, C, c, dst, src, n);
+        return;
+    }
+    q_chan_pat(pat, 8, N, C, c, 1);
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i v = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(src + i)));
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), _mm256_loadu_ps(pat + 8 * p)));
+        p = p + 1 == C ? 0 : p + 1;
+    }
+    q_b16_to_f32_ch_c(N, C, (c + i) % C, dst + i, src + i, n - i);
+}
+
+static inline void q_b32_to_f32_ch_avx2(const unsigned int *N, size_t C, size_t c, float32_t *dst, const fix32_t *src, size_t n)
+{
+    float32_t pat[8 * Q_CHAN_MAX];
+    size_t    i = 0, p = 0;
+
+    if (C > Q_CHAN_MAX)
+    {
+        q_b32_to_f32_ch_c(N, C, c, dst, src, n);
+        return;
+    }
+    q_chan_pat(pat, 8, N, C, c, 1);
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(src + i));
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), _mm256_loadu_ps(pat + 8 * p)));
+        p = p + 1 == C ? 0 : p + 1;
+    }
+    q_b32_to_f32_ch_c(N, C, (c + i) % C, dst + i, src + i, n - i);
+}
+
+Q_TARGET_END
+#endif /* Q_SIMD_AVX2 */
+
+
+#if Q_SIMD_AVX512
+Q_TARGET_AVX512_BEGIN
+
+static inline void q_f32_to_b16_ch_avx512(const unsigned int *N, size_t C, size_t c, fix16_t *dst, const float32_t *src, size_t n)
+{
+    const __m512 hi = _mm512_set1_ps((float32_t)Q_MAXb16);
+    const __m512 lo = _mm512_set1_ps((float32_t)Q_MINb16);
+    float32_t    pat[16 * Q_CHAN_MAX];
+    size_t       i = 0, p = 0;
+
+    if (C > Q_CHAN_MAX)
+    {
+        q_f32_to_b16_ch_c(N, C, c, dst, src, n);
+        return;
+    }
+    q_chan_pat(pat, 16, N, C, c, 0);
+    for (; i + 16 <= n; i += 16)
+    {
+        __m512 a = _mm512_mul_ps(_mm512_loadu_ps(src + i), _mm512_loadu_ps(pat + 16 * p));
+        a = _mm512_max_ps(_mm512_min_ps(a, hi), lo);
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm512_cvtepi32_epi16(_mm512_cvttps_epi32(a)));
+        p = p + 1 == C ? 0 : p + 1;
+    }
+    q_f32_to_b16_ch_c(N, C, (c + i) % C, dst + i, src + i, n - i);
+}
+
+static inline void q_f32_to_b32_ch_avx512(const unsigned int *N, size_t C, size_t c, fix32_t *dst, const float32_t *src, size_t n)
+{
+    const __m512  ovf  = _mm512_set1_ps(2147483648.0f);
+    const __m512i qmax = _mm512_set1_epi32(Q_MAXb32);
+    float32_t     pat[16 * Q_CHAN_MAX];
+    size_t        i = 0, p = 0;
+
+    if (C > Q_CHAN_MAX)
+    {
+        q_f32_to_b32_ch_c(N, C, c, dst, src, n);
+        return;
+    }
+    q_chan_pat(pat, 16, N, C, c, 0);
+    for (; i + 16 <= n; i += 16)
+    {
+        __m512    a = _mm512_mul_ps(_mm512_loadu_ps(src + i), _mm512_loadu_ps(pat + 16 * p));
+        __mmask16 m = _mm512_cmp_ps_mask(a, ovf, _CMP_GE_OQ);
+        _mm512_storeu_si512((void *)(dst + i), _mm512_mask_mov_epi32(_mm512_cvttps_epi32(a), m, qmax));
+        p = p + 1 == C ? 0 : p + 1;
+    }
+    q_f32_to_b32_ch_c(N, C, (c + i) % C, dst + i, src + i, n - i);
+}
+
+static inline void q_b16_to_f32_ch_avx512(const unsigned int *N, size_t C, size_t c, float32_t *dst, const fix16_t *src, size_t n)
+{
+    float32_t pat[16 * Q_CHAN_MAX];
+    size_t    i = 0, p = 0;
+
+    if (C > Q_CHAN_MAX)
+    {
+        q_b16_to_f32_ch_c(N, C, c, dst, src, n);
+        return;
+    }
+    q_chan_pat(pat, 16, N, C, c, 1);
+    for (; i + 16 <= n; i += 16)
+    {
+        __m512i v = _mm512_cvtepi16_epi32(_mm256_loadu_si256((const __m256i *)(src + i)));
+        _mm512_storeu_ps(dst + i, _mm512_mul_ps(_mm512_cvtepi32_ps(v), _mm512_loadu_ps(pat + 16 * p)));
+        p = p + 1 == C ? 0 : p + 1;
+    }
+    q_b16_to_f32_ch_c(N, C, (c + i) % C, dst + i, src + i, n - i);
+}
+
+static inline void q_b32_to_f32_ch_avx512(const unsigned int *N, size_t C, size_t c, float32_t *dst, const fix32_t *src, size_t n)
+{
+    float32_t pat[16 * Q_CHAN_MAX];
+    size_t    i = 0, p = 0;
+
+    if (C > Q_CHAN_MAX)
+    {
+        q_b32_to_f32_ch_c(N, C, c, dst, src, n);
+        return;
+    }
+    q_chan_pat(pat, 16, N, C, c, 1);
+    for (; i + 16 <= n; i += 16)
+    {
+        __m512i v = _mm512_loadu_si512((const void *)(src + i));
+        _mm512_storeu_ps(dst + i, _mm512_mul_ps(_mm512_cvtepi32_ps(v), _mm512_loadu_ps(pat + 16 * p)));
+        p = p + 1 == C ? 0 : p + 1;
+    }
+    q_b32_to_f32_ch_c(N, C, (c + i) % C, dst + i, src + i, n - i);
+}
+
+Q_TARGET_END
+#endif /* Q_SIMD_AVX512 */
+
+
+// Kernel table, bound once per translation unit to the tier from q_isa().
+
+typedef struct
+{
+    void (*f32_to_b16)(const unsigned int *N, size_t C, size_t c, fix16_t *dst, const float32_t *src, size_t n);
+    void (*f32_to_b32)(const unsigned int *N, size_t C, size_t c, fix32_t *dst, const float32_t *src, size_t n);
+    void (*b16_to_f32)(const unsigned int *N, size_t C, size_t c, float32_t *dst, const fix16_t *src, size_t n);
+    void (*b32_to_f32)(const unsigned int *N, size_t C, size_t c, float32_t *dst, const fix32_t *src, size_t n);
+    int    bound;
+} q_chan_fn_t;
+
+static q_chan_fn_t q_chan_k;
+
+/** @brief Fills q_chan_k for q_isa(). Runs before main() where supported. @note RARELY USE DIRECTLY. */
+static Q_CONSTRUCTOR void q_chan_bind(void)
+{
+    q_isa_t     isa = q_isa();
+    q_chan_fn_t k   = { q_f32_to_b16_ch_c, q_f32_to_b32_ch_c, q_b16_to_f32_ch_c, q_b32_to_f32_ch_c, 1 };
+
+    (void)isa;
+#if Q_SIMD_SSE2
+    if (isa >= Q_ISA_SSE2)
+    {
+        k.f32_to_b16 = q_f32_to_b16_ch_sse2;
+        k.f32_to_b32 = q_f32_to_b32_ch_sse2;
+        k.b16_to_f32 = q_b16_to_f32_ch_sse2;
+        k.b32_to_f32 = q_b32_to_f32_ch_sse2;
+    }
+#endif
+#if Q_SIMD_AVX2
+    if (isa >= Q_ISA_AVX2)
+    {
+        k.f32_to_b16 = q_f32_to_b16_ch_avx2;
+        k.f32_to_b32 = q_f32_to_b32_ch_avx2;
+        k.b16_to_f32 = q_b16_to_f32_ch_avx2;
+        k.b32_to_f32 = q_b32_to_f32_ch_avx2;
+    }
+#endif
+#if Q_SIMD_AVX512
+    if (isa >= Q_ISA_AVX512)
+    {
+        k.f32_to_b16 = q_f32_to_b16_ch_avx512;
+        k.f32_to_b32 = q_f32_to_b32_ch_avx512;
+        k.b16_to_f32 = q_b16_to_f32_ch_avx512;
+        k.b32_to_f32 = q_b32_to_f32_ch_avx512;
+    }
+#endif
+    q_chan_k = k;
+}
+
+/** @brief Bound kernel table. Binds on first use if the constructor has not run yet. @note RARELY USE DIRECTLY. */
+static inline const q_chan_fn_t *q_chan_fn(void)
+{
+    if (!q_chan_k.bound)
+    {
+        q_chan_bind();
+    }
+    return &q_chan_k;
+}
+
+
+/** @brief Frames per (de)interleave step for C channels. @note RARELY USE DIRECTLY. */
+#define Q_CHAN_FRAMES(C)    ( (C) <= Q_CHAN_BLOCK ? Q_CHAN_BLOCK / (C) : 1U )
+
+#define Q_CHAN_ARRAY(W, T)                                                                  \
+    /** @brief Qx_bxx() over strided arrays, strides in elements. */                        \
+    static inline void Qx_b##W##_array_s(unsigned int N, T *dst, ptrdiff_t dst_stride,      \
+                                         const float32_t *src, ptrdiff_t src_stride, size_t n) \
+    {                                                                                       \
+        for (size_t i = 0; i < n; i++, dst += dst_stride, src += src_stride)                \
+        {                                                                                   \
+            *dst = Qx_b##W(N, *src);                                                        \
+        }                                                                                   \
+    }                                                                                       \
+    /** @brief F_Qx_bxx() over strided arrays, strides in elements. */                      \
+    static inline void F_Qx_b##W##_array_s(unsigned int N, float32_t *dst, ptrdiff_t dst_stride, \
+                                           const T *src, ptrdiff_t src_stride, size_t n)     \
+    {                                                                                       \
+        for (size_t i = 0; i < n; i++, dst += dst_stride, src += src_stride)                \
+        {                                                                                   \
+            *dst = F_Qx_b##W(N, *src);                                                      \
+        }                                                                                   \
+    }                                                                                       \
+    /** @brief Interleaved floats to interleaved words, channel c in Q<N[c]>. */            \
+    static inline void Qx_b##W##_array_ch(const unsigned int *N, size_t C, T *dst,          \
+                                          const float32_t *src, size_t frames)              \
+    {                                                                                       \
+        q_chan_fn()->f32_to_b##W(N, C, 0, dst, src, frames * C);                            \
+    }                                                                                       \
+    /** @brief Interleaved words to interleaved floats, channel c in Q<N[c]>. */            \
+    static inline void F_Qx_b##W##_array_ch(const unsigned int *N, size_t C, float32_t *dst, \
+                                            const T *src, size_t frames)                    \
+    {                                                                                       \
+        q_chan_fn()->b##W##_to_f32(N, C, 0, dst, src, frames * C);                          \
+    }                                                                                       \
+    /** @brief Interleaved floats to C word arrays dst[c], channel c in Q<N[c]>. */         \
+    static inline void Qx_b##W##_deinterleave(const unsigned int *N, size_t C, T *const *dst, \
+                                              const float32_t *src, size_t frames)          \
+    {                                                                                       \
+        T      buf[Q_CHAN_BLOCK];                                                           \
+        size_t fb = Q_CHAN_FRAMES(C);                                                       \
+        for (size_t f = 0; f < frames; f += fb)                                             \
+        {                                                                                   \
+            size_t m = frames - f < fb ? frames - f : fb;                                   \
+            if (C > Q_CHAN_BLOCK)                                                           \
+            {                                                                               \
+                for (size_t c = 0; c < C; c++)                                              \
+                {                                                                           \
+                    dst[c][f] = Qx_b##W(N[c], src[f * C + c]);                              \
+                }                                                                           \
+                continue;                                                                   \
+            }                                                                               \
+            q_chan_fn()->f32_to_b##W(N, C, 0, buf, src + f * C, m * C);                     \
+            for (size_t c = 0; c < C; c++)                                                  \
+            {                                                                               \
+                for (size_t k = 0; k < m; k++)                                              \
+                {                                                                           \
+                    dst[c][f + k] = buf[k * C + c];                                         \
+                }                                                                           \
+            }                                                                               \
+        }                                                                                   \
+    }                                                                                       \
+    /** @brief C float arrays src[c] to interleaved words, channel c in Q<N[c]>. */         \
+    static inline void Qx_b##W##_interleave(const unsigned int *N, size_t C, T *dst,        \
+                                            const float32_t *const *src, size_t frames)     \
+    {                                                                                       \
+        float32_t buf[Q_CHAN_BLOCK];                                                        \
+        size_t    fb = Q_CHAN_FRAMES(C);                                                    \
+        for (size_t f = 0; f < frames; f += fb)                                             \
+        {                                                                                   \
+            size_t m = frames - f < fb ? frames - f : fb;                                   \
+            if (C > Q_CHAN_BLOCK)                                                           \
+            {                                                                               \
+                for (size_t c = 0; c < C; c++)                                              \
+                {                                                                           \
+                    dst[f * C + c] = Qx_b##W(N[c], src[c][f]);                              \
+                }                                                                           \
+                continue;                                                                   \
+            }                                                                               \
+            for (size_t c = 0; c < C; c++)                                                  \
+            {                                                                               \
+                for (size_t k = 0; k < m; k++)                                              \
+                {                                                                           \
+                    buf[k * C + c] = src[c][f + k];                                         \
+                }                                                                           \
+            }                                                                               \
+            q_chan_fn()->f32_to_b##W(N, C, 0, dst + f * C, buf, m * C);                     \
+        }                                                                                   \
+    }                                                                                       \
+    /** @brief Interleaved words to C float arrays dst[c], channel c in Q<N[c]>. */         \
+    static inline void F_Qx_b##W##_deinterleave(const unsigned int *N, size_t C, float32_t *const *dst, \
+                                                const T *src, size_t frames)                \
+    {                                                                                       \
+        float32_t buf[Q_CHAN_BLOCK];                                                        \
+        size_t    fb = Q_CHAN_FRAMES(C);                                                    \
+        for (size_t f = 0; f < frames; f += fb)                                             \
+        {                                                                                   \
+            size_t m = frames - f < fb ? frames - f : fb;                                   \
+            if (C > Q_CHAN_BLOCK)                                                           \
+            {                                                                               \
+                for (size_t c = 0; c < C; c++)                                              \
+                {                                                                           \
+                    dst[c][f] = F_Qx_b##W(N[c], src[f * C + c]);                            \
+                }                                                                           \
+                continue;                                                                   \
+            }                                                                               \
+            q_chan_fn()->b##W##_to_f32(N, C, 0, buf, src + f * C, m * C);                   \
+            for (size_t c = 0; c < C; c++)                                                  \
+            {                                                                               \
+                for (size_t k = 0; k < m; k++)                                              \
+                {                                                                           \
+                    dst[c][f + k] = buf[k * C + c];                                         \
+                }                                                                           \
+            }                                                                               \
+        }                                                                                   \
+    }                                                                                       \
+    /** @brief C word arrays src[c] to interleaved floats, channel c in Q<N[c]>. */         \
+    static inline void F_Qx_b##W##_interleave(const unsigned int *N, size_t C, float32_t *dst, \
+                                              const T *const *src, size_t frames)           \
+    {                                                                                       \
+        T      buf[Q_CHAN_BLOCK];                                                           \
+        size_t fb = Q_CHAN_FRAMES(C);                                                       \
+        for (size_t f = 0; f < frames; f += fb)                                             \
+        {                                                                                   \
+            size_t m = frames - f < fb ? frames - f : fb;                                   \
+            if (C > Q_CHAN_BLOCK)                                                           \
+            {                                                                               \
+                for (size_t c = 0; c < C; c++)                                              \
+                {                                                                           \
+                    dst[f * C + c] = F_Qx_b##W(N[c], src[c][f]);                            \
+                }                                                                           \
+                continue;                                                                   \
+            }                                                                               \
+            for (size_t c = 0; c < C; c++)                                                  \
+            {                                                                               \
+                for (size_t k = 0; k < m; k++)                                              \
+                {                                                                           \
+                    buf[k * C + c] = src[c][f + k];                                         \
+                }                                                                           \
+            }                                                                               \
+            q_chan_fn()->b##W##_to_f32(N, C, 0, dst + f * C, buf, m * C);                   \
+        }                                                                                   \
+    }
+
+
+// Use this!
+
+Q_CHAN_ARRAY(16, fix16_t)
+Q_CHAN_ARRAY(32, fix32_t)
+
+
+#endif /* SRC_Q_CHAN_H_ */
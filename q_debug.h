@@ -6,6 +6,21 @@
  *          Prints any Q format, words 8, 16, 32, and 64 bit.
  *          Prints arrays.
  *
+ *          Values are printed as exact decimals, generated from the integer
+ *          and fraction bits with integer arithmetic only (a Qn fraction has
+ *          at most n decimal digits), so Q31 and Q63 keep all their digits.
+ *
+ *          Large dumps go through q_dump_t: records are formatted into one
+ *          reusable buffer that is written with a single fwrite() when full,
+ *          as text, CSV or raw binary.
+ *
+ *          @code
+ *          q_dump_t d;
+ *          q_dump_open(&d, f, Q_DUMP_CSV, 0);
+ *          q_dump_array(&d, 32, 31, "x", x, 0, n - 1);   // "x,0,-0.25\n" ...
+ *          q_dump_close(&d);
+ *          @endcode
+ *
  * @note    Use only when debugging.
  */
 
@@ -14,20 +29,236 @@
 
 
 #include "q_macros.h"
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define Q_FMT_MAX   88U             /**< Longest q_fmt_q() output: sign, 19 integer digits, point, 63 fraction digits. */
+#define Q_DUMP_BUF  (1U << 20)      /**< Default q_dump_t buffer, bytes. */
+
+/** @brief Output of q_dump_t. */
+typedef enum
+{
+    Q_DUMP_TEXT = 0,    /**< "Q15 - name[ 3]: +0.5", as PRINT_ARRAY_Q. */
+    Q_DUMP_CSV,         /**< "name,3,0.5" */
+    Q_DUMP_BINARY       /**< The raw words, native endian. */
+} q_dump_fmt_t;
+
+/** @brief Buffered writer for array dumps. */
+typedef struct
+{
+    FILE         *f;
+    char         *buf;
+    size_t        cap;
+    size_t        len;
+    q_dump_fmt_t  fmt;
+} q_dump_t;
+
+
+/** @brief "00" .. "99". @note RARELY USE DIRECTLY. */
+static const char q_fmt_pairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+/** @brief Writes u in decimal, right aligned in at least width characters (space padded, like %*u). Returns length. @note RARELY USE DIRECTLY. */
+static inline size_t q_fmt_u64(char *out, uint64_t u, unsigned int width)
+{
+    char   tmp[20];
+    size_t k = sizeof(tmp);
+
+    while (u >= 100U)
+    {
+        unsigned int r = (unsigned int)(u % 100U) * 2U;
+        u   /= 100U;
+        tmp[--k] = q_fmt_pairs[r + 1U];
+        tmp[--k] = q_fmt_pairs[r];
+    }
+    if (u >= 10U)
+    {
+        tmp[--k] = q_fmt_pairs[u * 2U + 1U];
+        tmp[--k] = q_fmt_pairs[u * 2U];
+    }
+    else
+    {
+        tmp[--k] = (char)('0' + u);
+    }
+    while (sizeof(tmp) - k < width && k > 0)
+    {
+        tmp[--k] = ' ';
+    }
+    memcpy(out, tmp + k, sizeof(tmp) - k);
+    return sizeof(tmp) - k;
+}
+
+/**
+ * @brief Writes the exact decimal value of the Qn word v (sign extended to 64
+ *        bits), e.g. "-0.000030517578125" for Q15 -1. No float is involved:
+ *        the fraction, left aligned in 64 bits, is multiplied by 100 in two
+ *        32-bit halves and the carry out is the next two digits. Trailing
+ *        zeros are dropped, one fraction digit is kept.
+ *        Writes at most Q_FMT_MAX bytes, no terminator. Returns the length.
+ */
+static inline size_t q_fmt_q(char *out, int64_t v, unsigned int N)
+{
+    uint64_t u   = v < 0 ? 0U - (uint64_t)v : (uint64_t)v;
+    uint64_t g   = N == 0U ? 0U : u << (64U - N);
+    size_t   len = 0;
+
+    if (v < 0)
+    {
+        out[len++] = '-';
+    }
+    len += q_fmt_u64(out + len, N >= 64U ? 0U : u >> N, 0);
+    out[len++] = '.';
+    if (g == 0U)
+    {
+        out[len++] = '0';
+    }
+    else
+    {
+        while (g != 0U)
+        {
+            uint64_t     lo = (g & 0xFFFFFFFFU) * 100U;
+            uint64_t     hi = (g >> 32) * 100U + (lo >> 32);
+            unsigned int d  = (unsigned int)(hi >> 32) * 2U;
+
+            g = (hi << 32) | (lo & 0xFFFFFFFFU);
+            out[len++] = q_fmt_pairs[d];
+            out[len++] = q_fmt_pairs[d + 1U];
+        }
+        len -= out[len - 1] == '0';     /* The last pair is never "00". */
+    }
+    return len;
+}
+
+/** @brief Element i of a bits-wide (8, 16, 32, 64) array, sign extended. @note RARELY USE DIRECTLY. */
+static inline int64_t q_dump_word(unsigned int bits, const void *src, size_t i)
+{
+    switch (bits)
+    {
+        case 8:     return ((const fix8_t *)src)[i];
+        case 16:    return ((const fix16_t *)src)[i];
+        case 32:    return ((const fix32_t *)src)[i];
+        default:    return ((const fix64_t *)src)[i];
+    }
+}
+
+
+// Use this!
+
+/** @brief Writes out what is buffered, one fwrite(). Returns 0, -1 on a write error. */
+static inline int q_dump_flush(q_dump_t *d)
+{
+    size_t len = d->len;
+
+    d->len = 0;
+    return len == 0 || fwrite(d->buf, 1, len, d->f) == len ? 0 : -1;
+}
+
+/**
+ * @brief Starts a dump to f with a buffer of cap bytes (0: Q_DUMP_BUF, at
+ *        least 4 KiB). The buffer is reused by every q_dump_array() until
+ *        q_dump_close(). Returns 0, -1 if out of memory.
+ */
+static inline int q_dump_open(q_dump_t *d, FILE *f, q_dump_fmt_t fmt, size_t cap)
+{
+    d->cap = cap == 0 ? Q_DUMP_BUF : cap < 4096U ? 4096U : cap;
+    d->buf = (char *)malloc(d->cap);
+    d->f   = f;
+    d->len = 0;
+    d->fmt = fmt;
+    return d->buf != NULL ? 0 : -1;
+}
+
+/** @brief Flushes and frees the buffer (not f). Returns 0, -1 on a write error. */
+static inline int q_dump_close(q_dump_t *d)
+{
+    int r = q_dump_flush(d);
+
+    free(d->buf);
+    d->buf = NULL;
+    return r;
+}
+
+/**
+ * @brief Dumps elements start..stop (inclusive) of a bits-wide (8, 16, 32,
+ *        64) Qn array; name labels the text and CSV records.
+ *        Returns 0, -1 on a write error.
+ */
+static inline int q_dump_array(q_dump_t *d, unsigned int bits, unsigned int N, const char *name,
+                               const void *src, size_t start, size_t stop)
+{
+    size_t nlen = strlen(name);
+    size_t rec  = nlen + 2U * Q_FMT_MAX;    /* Worst case text or CSV record. */
+
+    if (d->fmt == Q_DUMP_BINARY)
+    {
+        size_t w = bits / 8U;
+        if (stop < start || q_dump_flush(d) != 0)
+        {
+            return stop < start ? 0 : -1;
+        }
+        return fwrite((const char *)src + start * w, w, stop - start + 1U, d->f) == stop - start + 1U ? 0 : -1;
+    }
+    if (rec > d->cap)
+    {
+        return -1;      /* Name too long for the buffer. */
+    }
+    for (size_t i = start; stop >= start && i - start <= stop - start; i++)
+    {
+        int64_t v = q_dump_word(bits, src, i);
+        char   *p;
+
+        if (d->cap - d->len < rec && q_dump_flush(d) != 0)
+        {
+            return -1;
+        }
+        p = d->buf + d->len;
+        if (d->fmt == Q_DUMP_TEXT)
+        {
+            *p++ = 'Q';
+            p   += q_fmt_u64(p, N, 0);
+            memcpy(p, " - ", 3);
+            p   += 3;
+            memcpy(p, name, nlen);
+            p   += nlen;
+            *p++ = '[';
+            p   += q_fmt_u64(p, i, 2);
+            memcpy(p, "]: ", 3);
+            p   += 3;
+            if (v >= 0)
+            {
+                *p++ = '+';
+            }
+        }
+        else
+        {
+            memcpy(p, name, nlen);
+            p   += nlen;
+            *p++ = ',';
+            p   += q_fmt_u64(p, i, 0);
+            *p++ = ',';
+        }
+        p   += q_fmt_q(p, v, N);
+        *p++ = '\n';
+        d->len = (size_t)(p - d->buf);
+    }
+    return 0;
+}
 
 /**
- * @brief Prints fixed-point value as float.
- *        First conversion is done via F_Qx_b macro, then the values is printed
- *        out.
+ * @brief Prints fixed-point value as exact decimal.
  *        @note RARELY USE DIRECTLY.
  * */
 #define PRINT_Q(MAXSIZE, N, name)                                             \
     {                                                                         \
-        float32_t grbmqpxtk = F_Qx_b##MAXSIZE(N,name);                        \
+        char grbmqpxtk[Q_FMT_MAX + 1];                                        \
+        grbmqpxtk[q_fmt_q(grbmqpxtk, (int64_t)(name), N)] = '\0';             \
         printf("Q" #N "\t- " );                                               \
         printf("%-48s", #name);                                               \
-        printf(": %27.21f  \n", grbmqpxtk);                                   \
+        printf(": %27s  \n", grbmqpxtk);                                      \
     }
 
 /**
@@ -36,22 +267,25 @@
  * */
 #define PRINT_ARRAY_ELEMENT_Q(MAXSIZE, N, name, index)                         \
     {                                                                          \
-        float32_t grbmqpxtk = F_Q##N##b##MAXSIZE(name[index]);                 \
+        char grbmqpxtk[Q_FMT_MAX + 1];                                         \
+        grbmqpxtk[q_fmt_q(grbmqpxtk, (int64_t)name[index], N)] = '\0';         \
         printf("Q" #N " - " );                                                 \
         printf("%s[%2d]", #name, index);                                       \
-        printf(": %+.21f \n", grbmqpxtk);                                      \
+        printf(": %s%s \n", name[index] >= 0 ? "+" : "", grbmqpxtk);           \
     }
 
 /**
  * @brief Prints fixed-point array, together with array index, from start to
- *        stop possition.
+ *        stop possition. Buffered, one fwrite() per Q_DUMP_BUF of text.
  *        @note RARELY USE DIRECTLY.
  * */
 #define PRINT_ARRAY_Q(MAXSIZE, N, name, start, stop)                           \
     {                                                                          \
-        for(int index=start;index<=stop;index++)                               \
+        q_dump_t grbmqpxtk;                                                    \
+        if (q_dump_open(&grbmqpxtk, stdout, Q_DUMP_TEXT, 0) == 0)              \
         {                                                                      \
-            PRINT_ARRAY_ELEMENT_Q(MAXSIZE, N, name, index);                    \
+            q_dump_array(&grbmqpxtk, MAXSIZE, N, #name, name, start, stop);    \
+            q_dump_close(&grbmqpxtk);                                          \
         }                                                                      \
         printf("...\n");                                                       \
     }
@@ -60,39 +294,39 @@
 // Print variables
 
 // 16-bit
-#define PRINT_Q7_8b(name)   PRINT_Q(08, 7, name)  /**< @brief Prints single 8-bit Q7 fixed-point variable as float. */
-#define PRINT_Q6_8b(name)   PRINT_Q(08, 6, name)  /**< @brief Prints single 8-bit Q6 fixed-point variable as float. */
+#define PRINT_Q7_8b(name)   PRINT_Q(08, 7, name)  /**< @brief Prints single 8-bit Q7 fixed-point variable as exact decimal. */
+#define PRINT_Q6_8b(name)   PRINT_Q(08, 6, name)  /**< @brief Prints single 8-bit Q6 fixed-point variable as exact decimal. */
 
 // 16-bit
-#define PRINT_Q15_16b(name) PRINT_Q(16, 15, name) /**< @brief Prints single 16-bit Q15 fixed-point variable as float. */
-#define PRINT_Q14_16b(name) PRINT_Q(16, 14, name) /**< @brief Prints single 16-bit Q14 fixed-point variable as float. */
+#define PRINT_Q15_16b(name) PRINT_Q(16, 15, name) /**< @brief Prints single 16-bit Q15 fixed-point variable as exact decimal. */
+#define PRINT_Q14_16b(name) PRINT_Q(16, 14, name) /**< @brief Prints single 16-bit Q14 fixed-point variable as exact decimal. */
 
 // 32-bit
-#define PRINT_Q31_32b(name) PRINT_Q(32, 31, name) /**< @brief Prints single 32-bit Q31 fixed-point variable as float. */
-#define PRINT_Q30_32b(name) PRINT_Q(32, 30, name) /**< @brief Prints single 32-bit Q30 fixed-point variable as float. */
+#define PRINT_Q31_32b(name) PRINT_Q(32, 31, name) /**< @brief Prints single 32-bit Q31 fixed-point variable as exact decimal. */
+#define PRINT_Q30_32b(name) PRINT_Q(32, 30, name) /**< @brief Prints single 32-bit Q30 fixed-point variable as exact decimal. */
 
 // 64-bit
-#define PRINT_Q63_64b(name) PRINT_Q(64, 63, name) /**< @brief Prints single 64-bit Q63 fixed-point variable as float. */
-#define PRINT_Q62_64b(name) PRINT_Q(64, 62, name) /**< @brief Prints single 64-bit Q62 fixed-point variable as float. */
+#define PRINT_Q63_64b(name) PRINT_Q(64, 63, name) /**< @brief Prints single 64-bit Q63 fixed-point variable as exact decimal. */
+#define PRINT_Q62_64b(name) PRINT_Q(64, 62, name) /**< @brief Prints single 64-bit Q62 fixed-point variable as exact decimal. */
 
 
 // PRINTING ARRAYS:
 
 // 8 bit arrays
-#define PRINT_ARRAY_Q7_8b(name, start, stop)    PRINT_ARRAY_Q(8, 7, name, start, stop)   /**< @brief Prints array of 8-bit Q7 fixed-point variables as floats. */
-#define PRINT_ARRAY_Q6_8b(name, start, stop)    PRINT_ARRAY_Q(8, 6, name, start, stop)   /**< @brief Prints array of 8-bit Q6 fixed-point variables as floats. */
+#define PRINT_ARRAY_Q7_8b(name, start, stop)    PRINT_ARRAY_Q(8, 7, name, start, stop)   /**< @brief Prints array of 8-bit Q7 fixed-point variables as exact decimals. */
+#define PRINT_ARRAY_Q6_8b(name, start, stop)    PRINT_ARRAY_Q(8, 6, name, start, stop)   /**< @brief Prints array of 8-bit Q6 fixed-point variables as exact decimals. */
 
 // 16 bit arrays
-#define PRINT_ARRAY_Q15_16b(name, start, stop)  PRINT_ARRAY_Q(16, 15, name, start, stop) /**< @brief Prints array of 16-bit Q15 fixed-point variables as floats. */
-#define PRINT_ARRAY_Q14_16b(name, start, stop)  PRINT_ARRAY_Q(16, 14, name, start, stop) /**< @brief Prints array of 16-bit Q14 fixed-point variables as floats. */
+#define PRINT_ARRAY_Q15_16b(name, start, stop)  PRINT_ARRAY_Q(16, 15, name, start, stop) /**< @brief Prints array of 16-bit Q15 fixed-point variables as exact decimals. */
+#define PRINT_ARRAY_Q14_16b(name, start, stop)  PRINT_ARRAY_Q(16, 14, name, start, stop) /**< @brief Prints array of 16-bit Q14 fixed-point variables as exact decimals. */
 
 // 32-bit arrays
-#define PRINT_ARRAY_Q31_32b(name, start, stop)  PRINT_ARRAY_Q(32, 31, name, start, stop) /**< @brief Prints array of 32-bit Q31 fixed-point variables as floats. */
-#define PRINT_ARRAY_Q30_32b(name, start, stop)  PRINT_ARRAY_Q(32, 30, name, start, stop) /**< @brief Prints array of 32-bit Q30 fixed-point variables as floats. */
+#define PRINT_ARRAY_Q31_32b(name, start, stop)  PRINT_ARRAY_Q(32, 31, name, start, stop) /**< @brief Prints array of 32-bit Q31 fixed-point variables as exact decimals. */
+#define PRINT_ARRAY_Q30_32b(name, start, stop)  PRINT_ARRAY_Q(32, 30, name, start, stop) /**< @brief Prints array of 32-bit Q30 fixed-point variables as exact decimals. */
 
 // 64 bit arrays
-#define PRINT_ARRAY_Q63_64b(name, start, stop)  PRINT_ARRAY_Q(64, 63, name, start, stop) /**< @brief Prints array of 64-bit Q63 fixed-point variables as floats. */
-#define PRINT_ARRAY_Q62_64b(name, start, stop)  PRINT_ARRAY_Q(64, 62, name, start, stop) /**< @brief Prints array of 64-bit Q62 fixed-point variables as floats. */
+#define PRINT_ARRAY_Q63_64b(name, start, stop)  PRINT_ARRAY_Q(64, 63, name, start, stop) /**< @brief Prints array of 64-bit Q63 fixed-point variables as exact decimals. */
+#define PRINT_ARRAY_Q62_64b(name, start, stop)  PRINT_ARRAY_Q(64, 62, name, start, stop) /**< @brief Prints array of 64-bit Q62 fixed-point variables as exact decimals. */
 
 
 #endif /* SRC_Q_DEBUG_H_ */
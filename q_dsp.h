@@ -0,0 +1,353 @@
+/**
+ * @file    q_dsp.h
+ * @brief   Dot product, block FIR and small matrix multiply for Q15
+ *          (fix16_t) and Q31 (fix32_t).
+ *
+ *          Products are summed exactly in a wide accumulator and rounded once
+ *          at the end, half up (same rule as q_requant.h), then saturated to
+ *          Q_MINbxx .. Q_MAXbxx. The result does not depend on the order of
+ *          the sum, so every tier gives the same bits.
+ *          - Q15: Q30 products in an int64_t, exact for n < 2^33. pmaddwd
+ *            on SSE2 / AVX2 / AVX-512BW, widened to 64-bit lanes.
+ *          - Q31: Q62 products split into a signed high and an unsigned low
+ *            32-bit half (q_dsp_acc_t, 96 bits), exact for n < 2^32.
+ *            vpmuldq on AVX2 / AVX-512.
+ *
+ *          - Q15_dot(x, y, n), Q31_dot(): sum of x[i] * y[i].
+ *          - Q15_fir(dst, x, h, taps, n), Q31_fir(): dst[i] = sum of
+ *            h[k] * x[i + k], k < taps. x holds taps - 1 samples of history
+ *            followed by the n new ones; h is in time-reversed order (h[0]
+ *            weighs the oldest sample), as in CMSIS-DSP.
+ *          - Q15_gemm(C, A, Bt, M, N, K), Q31_gemm(): C = A * B, all row
+ *            major, B given transposed (Bt is N x K) so every output is one
+ *            contiguous dot product.
+ *
+ *          @code
+ *          fix16_t e = Q15_dot(x, x, n);               // energy, Q15
+ *          Q15_fir(out, buf, h, taps, n);              // buf = taps - 1 old + n new samples
+ *          memmove(buf, buf + n, (taps - 1) * sizeof(fix16_t));
+ *          @endcode
+ *
+ * @note    Q15_dot_acc() returns the exact Q30 sum, for another output
+ *          format use q_requant_i64() on it.
+ * @note    The FIR runs one dot product per output, vectorized over the
+ *          taps; short filters (under 16 taps) get little from SIMD.
+ */
+
+#ifndef SRC_Q_DSP_H_
+#define SRC_Q_DSP_H_
+
+
+#include "q_macros.h"
+#include "q_requant.h"
+#include "q_simd.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/** @brief Exact sum of Q31 products: hi * 2^32 + lo. @note RARELY USE DIRECTLY. */
+typedef struct
+{
+    int64_t  hi;
+    uint64_t lo;
+} q_dsp_acc_t;
+
+/** @brief Q62 sum to Q31, rounded half up and saturated. @note RARELY USE DIRECTLY. */
+static inline fix32_t q_dsp_round32(q_dsp_acc_t a)
+{
+    /* hi * 2^32 is 2 hi in units of 2^31, only lo needs the rounding shift. */
+    int64_t r = 2 * a.hi + (int64_t)((a.lo + (UINT64_C(1) << 30)) >> 31);
+    return r > Q_MAXb32 ? Q_MAXb32 : (r < Q_MINb32 ? Q_MINb32 : (fix32_t)r);
+}
+
+
+// Plain C kernels
+
+static inline int64_t q_dot16_c(const fix16_t *x, const fix16_t *y, size_t n)
+{
+    int64_t s = 0;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        s += (int32_t)x[i] * y[i];
+    }
+    return s;
+}
+
+static inline q_dsp_acc_t q_dot32_c(const fix32_t *x, const fix32_t *y, size_t n)
+{
+    q_dsp_acc_t a = { 0, 0 };
+
+    for (size_t i = 0; i < n; i++)
+    {
+        int64_t p = (int64_t)x[i] * y[i];
+        a.hi += p >> 32;
+        a.lo += (uint32_t)p;
+    }
+    return a;
+}
+
+
+/*
+ * pmaddwd adds two Q30 products into an int32 lane; that only wraps for two
+ * -32768 * -32768 pairs (2^31). The pair sum minus 2^16 always fits, so the
+ * kernels widen that and add the 2^16 per lane back at the end.
+ */
+#define Q_DSP_MADD_BIAS     0x10000
+
+#if Q_SIMD_SSE2
+Q_TARGET_SSE2_BEGIN
+
+static inline int64_t q_dot16_sse2(const fix16_t *x, const fix16_t *y, size_t n)
+{
+    const __m128i bias = _mm_set1_epi32(Q_DSP_MADD_BIAS);
+    __m128i       acc  = _mm_setzero_si128();
+    int64_t       r[2];
+    size_t        i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i *)(x + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(y + i));
+        __m128i p = _mm_sub_epi32(_mm_madd_epi16(a, b), bias);
+        __m128i s = _mm_srai_epi32(p, 31);
+        acc = _mm_add_epi64(acc, _mm_add_epi64(_mm_unpacklo_epi32(p, s), _mm_unpackhi_epi32(p, s)));
+    }
+    _mm_storeu_si128((__m128i *)r, acc);
+    return r[0] + r[1] + (int64_t)(i / 2) * Q_DSP_MADD_BIAS + q_dot16_c(x + i, y + i, n - i);
+}
+
+Q_TARGET_END
+#endif /* Q_SIMD_SSE2 */
+
+
+#if Q_SIMD_AVX2
+Q_TARGET_AVX2_BEGIN
+
+static inline int64_t q_dot16_avx2(const fix16_t *x, const fix16_t *y, size_t n)
+{
+    const __m256i bias = _mm256_set1_epi32(Q_DSP_MADD_BIAS);
+    __m256i       acc0 = _mm256_setzero_si256();
+    __m256i       acc1 = _mm256_setzero_si256();
+    int64_t       r[4];
+    size_t        i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(x + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(y + i));
+        __m256i p = _mm256_sub_epi32(_mm256_madd_epi16(a, b), bias);
+        acc0 = _mm256_add_epi64(acc0, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(p)));
+        acc1 = _mm256_add_epi64(acc1, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(p, 1)));
+    }
+    _mm256_storeu_si256((__m256i *)r, _mm256_add_epi64(acc0, acc1));
+    return r[0] + r[1] + r[2] + r[3] + (int64_t)(i / 2) * Q_DSP_MADD_BIAS + q_dot16_c(x + i, y + i, n - i);
+}
+
+static inline q_dsp_acc_t q_dot32_avx2(const fix32_t *x, const fix32_t *y, size_t n)
+{
+    const __m256i lo32 = _mm256_set1_epi64x(0xFFFFFFFF);
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i       hi   = zero;      /* High halves as unsigned ... */
+    __m256i       neg  = zero;      /* ... minus 1 per negative product (no 64-bit arithmetic shift). */
+    __m256i       lo   = zero;
+    int64_t       h[4], m[4];
+    uint64_t      l[4];
+    q_dsp_acc_t   a;
+    size_t        i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i u  = _mm256_loadu_si256((const __m256i *)(x + i));
+        __m256i v  = _mm256_loadu_si256((const __m256i *)(y + i));
+        __m256i pe = _mm256_mul_epi32(u, v);
+        __m256i po = _mm256_mul_epi32(_mm256_srli_epi64(u, 32), _mm256_srli_epi64(v, 32));
+        hi  = _mm256_add_epi64(hi, _mm256_add_epi64(_mm256_srli_epi64(pe, 32), _mm256_srli_epi64(po, 32)));
+        neg = _mm256_add_epi64(neg, _mm256_add_epi64(_mm256_cmpgt_epi64(zero, pe), _mm256_cmpgt_epi64(zero, po)));
+        lo  = _mm256_add_epi64(lo, _mm256_add_epi64(_mm256_and_si256(pe, lo32), _mm256_and_si256(po, lo32)));
+    }
+    _mm256_storeu_si256((__m256i *)h, hi);
+    _mm256_storeu_si256((__m256i *)m, neg);
+    _mm256_storeu_si256((__m256i *)l, lo);
+    a = q_dot32_c(x + i, y + i, n - i);
+    a.hi += h[0] + h[1] + h[2] + h[3] + (m[0] + m[1] + m[2] + m[3]) * (INT64_C(1) << 32);
+    a.lo += l[0] + l[1] + l[2] + l[3];
+    return a;
+}
+
+Q_TARGET_END
+#endif /* Q_SIMD_AVX2 */
+
+
+#if Q_SIMD_AVX512
+Q_TARGET_AVX512_BEGIN
+
+static inline int64_t q_dot16_avx512(const fix16_t *x, const fix16_t *y, size_t n)
+{
+    const __m512i bias = _mm512_set1_epi32(Q_DSP_MADD_BIAS);
+    __m512i       acc0 = _mm512_setzero_si512();
+    __m512i       acc1 = _mm512_setzero_si512();
+    size_t        i = 0;
+
+    for (; i + 32 <= n; i += 32)
+    {
+        __m512i a = _mm512_loadu_si512((const void *)(x + i));
+        __m512i b = _mm512_loadu_si512((const void *)(y + i));
+        __m512i p = _mm512_sub_epi32(_mm512_madd_epi16(a, b), bias);
+        acc0 = _mm512_add_epi64(acc0, _mm512_cvtepi32_epi64(_mm512_castsi512_si256(p)));
+        acc1 = _mm512_add_epi64(acc1, _mm512_cvtepi32_epi64(_mm512_extracti64x4_epi64(p, 1)));
+    }
+    return _mm512_reduce_add_epi64(_mm512_add_epi64(acc0, acc1)) + (int64_t)(i / 2) * Q_DSP_MADD_BIAS +
+           q_dot16_c(x + i, y + i, n - i);
+}
+
+static inline q_dsp_acc_t q_dot32_avx512(const fix32_t *x, const fix32_t *y, size_t n)
+{
+    const __m512i lo32 = _mm512_set1_epi64(0xFFFFFFFF);
+    __m512i       hi   = _mm512_setzero_si512();
+    __m512i       lo   = _mm512_setzero_si512();
+    q_dsp_acc_t   a;
+    size_t        i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m512i u  = _mm512_loadu_si512((const void *)(x + i));
+        __m512i v  = _mm512_loadu_si512((const void *)(y + i));
+        __m512i pe = _mm512_mul_epi32(u, v);
+        __m512i po = _mm512_mul_epi32(_mm512_srli_epi64(u, 32), _mm512_srli_epi64(v, 32));
+        hi = _mm512_add_epi64(hi, _mm512_add_epi64(_mm512_srai_epi64(pe, 32), _mm512_srai_epi64(po, 32)));
+        lo = _mm512_add_epi64(lo, _mm512_add_epi64(_mm512_and_si512(pe, lo32), _mm512_and_si512(po, lo32)));
+    }
+    a = q_dot32_c(x + i, y + i, n - i);
+    a.hi += _mm512_reduce_add_epi64(hi);
+    a.lo += (uint64_t)_mm512_reduce_add_epi64(lo);
+    return a;
+}
+
+Q_TARGET_END
+#endif /* Q_SIMD_AVX512 */
+
+
+// Kernel table, bound once per translation unit to the tier from q_isa().
+
+typedef struct
+{
+    int64_t     (*dot16)(const fix16_t *x, const fix16_t *y, size_t n);
+    q_dsp_acc_t (*dot32)(const fix32_t *x, const fix32_t *y, size_t n);
+    int           bound;
+} q_dsp_fn_t;
+
+static q_dsp_fn_t q_dsp_k;
+
+/** @brief Fills q_dsp_k for q_isa(). Runs before main() where supported. @note RARELY USE DIRECTLY. */
+static Q_CONSTRUCTOR void q_dsp_bind(void)
+{
+    q_isa_t    isa = q_isa();
+    q_dsp_fn_t k   = { q_dot16_c, q_dot32_c, 1 };
+
+    (void)isa;
+#if Q_SIMD_SSE2
+    if (isa >= Q_ISA_SSE2)
+    {
+        k.dot16 = q_dot16_sse2;
+    }
+#endif
+#if Q_SIMD_AVX2
+    if (isa >= Q_ISA_AVX2)
+    {
+        k.dot16 = q_dot16_avx2;
+        k.dot32 = q_dot32_avx2;
+    }
+#endif
+#if Q_SIMD_AVX512
+    if (isa >= Q_ISA_AVX512)
+    {
+        k.dot16 = q_dot16_avx512;
+        k.dot32 = q_dot32_avx512;
+    }
+#endif
+    q_dsp_k = k;
+}
+
+/** @brief Bound kernel table. Binds on first use if the constructor has not run yet. @note RARELY USE DIRECTLY. */
+static inline const q_dsp_fn_t *q_dsp_fn(void)
+{
+    if (!q_dsp_k.bound)
+    {
+        q_dsp_bind();
+    }
+    return &q_dsp_k;
+}
+
+
+// Use this!
+
+/** @brief Exact sum of x[i] * y[i] in Q30. */
+static inline int64_t Q15_dot_acc(const fix16_t *x, const fix16_t *y, size_t n)
+{
+    return q_dsp_fn()->dot16(x, y, n);
+}
+
+/** @brief Sum of x[i] * y[i], rounded and saturated to Q15. */
+static inline fix16_t Q15_dot(const fix16_t *x, const fix16_t *y, size_t n)
+{
+    return (fix16_t)q_requant_i64(q_dsp_fn()->dot16(x, y, n), 15, Q_MINb16, Q_MAXb16);
+}
+
+/** @brief Sum of x[i] * y[i], rounded and saturated to Q31. */
+static inline fix32_t Q31_dot(const fix32_t *x, const fix32_t *y, size_t n)
+{
+    return q_dsp_round32(q_dsp_fn()->dot32(x, y, n));
+}
+
+/** @brief dst[i] = sum of h[k] * x[i + k] over k < taps, Q15. x has n + taps - 1 samples, h is time-reversed. */
+static inline void Q15_fir(fix16_t *dst, const fix16_t *x, const fix16_t *h, size_t taps, size_t n)
+{
+    const q_dsp_fn_t *k = q_dsp_fn();
+
+    for (size_t i = 0; i < n; i++)
+    {
+        dst[i] = (fix16_t)q_requant_i64(k->dot16(h, x + i, taps), 15, Q_MINb16, Q_MAXb16);
+    }
+}
+
+/** @brief dst[i] = sum of h[k] * x[i + k] over k < taps, Q31. x has n + taps - 1 samples, h is time-reversed. */
+static inline void Q31_fir(fix32_t *dst, const fix32_t *x, const fix32_t *h, size_t taps, size_t n)
+{
+    const q_dsp_fn_t *k = q_dsp_fn();
+
+    for (size_t i = 0; i < n; i++)
+    {
+        dst[i] = q_dsp_round32(k->dot32(h, x + i, taps));
+    }
+}
+
+/** @brief C = A * B in Q15. A is M x K, Bt is B transposed (N x K), C is M x N, all row major. */
+static inline void Q15_gemm(fix16_t *C, const fix16_t *A, const fix16_t *Bt, size_t M, size_t N, size_t K)
+{
+    const q_dsp_fn_t *k = q_dsp_fn();
+
+    for (size_t m = 0; m < M; m++)
+    {
+        for (size_t j = 0; j < N; j++)
+        {
+            C[m * N + j] = (fix16_t)q_requant_i64(k->dot16(A + m * K, Bt + j * K, K), 15, Q_MINb16, Q_MAXb16);
+        }
+    }
+}
+
+/** @brief C = A * B in Q31. A is M x K, Bt is B transposed (N x K), C is M x N, all row major. */
+static inline void Q31_gemm(fix32_t *C, const fix32_t *A, const fix32_t *Bt, size_t M, size_t N, size_t K)
+{
+    const q_dsp_fn_t *k = q_dsp_fn();
+
+    for (size_t m = 0; m < M; m++)
+    {
+        for (size_t j = 0; j < N; j++)
+        {
+            C[m * N + j] = q_dsp_round32(k->dot32(A + m * K, Bt + j * K, K));
+        }
+    }
+}
+
+
+#endif /* SRC_Q_DSP_H_ */
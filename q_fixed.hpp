@@ -0,0 +1,151 @@
+/**
+ * @file    q_fixed.hpp
+ * @brief   C++ constexpr fixed-point type for 8, 16, 32 and 64 bit words.
+ *
+ *          q::fixed<W, N> replaces the per-format aliases from q_macros.h
+ *          (Q15_b16, F_Q31b32, ...) with one template over the word type
+ *          W (fix8_t, fix16_t, fix32_t, fix64_t) and fraction bits N.
+ *          Conversions use the same expressions as Qx_bxx()/F_Qx_bxx(), so
+ *          results are bit-identical and hot loops compile to the same code.
+ *          Invalid W or N is a compile error.
+ *
+ *          Everything is constexpr: a table assigned to a constexpr variable
+ *          is guaranteed to be computed by the compiler, nothing at startup.
+ *
+ *          @code
+ *          static constexpr auto taps = q::q15::table({ 0.25f, 0.5f, 0.25f });
+ *          static_assert(taps[1] == Q15(0.5f), "");
+ *          @endcode
+ *
+ * @note    Needs C++14.
+ */
+
+#ifndef SRC_Q_FIXED_HPP_
+#define SRC_Q_FIXED_HPP_
+
+
+#include "types.h"
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+namespace q
+{
+
+template <typename W, unsigned int N>
+struct fixed
+{
+    static_assert(std::is_same<W, fix8_t >::value || std::is_same<W, fix16_t>::value ||
+                  std::is_same<W, fix32_t>::value || std::is_same<W, fix64_t>::value,
+                  "q::fixed: word type must be fix8_t, fix16_t, fix32_t or fix64_t");
+
+    static constexpr unsigned int word_bits = sizeof(W) * 8U;   /**< @brief Bits in word. */
+    static constexpr unsigned int frac_bits = N;                /**< @brief Bits in fractional part. */
+
+    static_assert(N >= 1U && N <= word_bits - 1U, "q::fixed: N must be 1 .. word bits - 1");
+
+    using word_type = W;
+
+    static constexpr W         q_max   = std::numeric_limits<W>::max();               /**< @brief Same as Q_MAXbxx. */
+    static constexpr W         q_min   = std::numeric_limits<W>::min();               /**< @brief Same as Q_MINbxx. */
+    static constexpr float32_t scale   = (float32_t)(1ULL << N);                      /**< @brief Same as SCALE_FACTOR_xx(N). */
+    static constexpr float32_t f_max   = (float32_t)(1ULL << (word_bits - 1U - N));   /**< @brief Same as F_MAXbxx(N). */
+    static constexpr float32_t f_min   = -f_max;                                      /**< @brief Same as F_MINbxx(N). */
+    static constexpr float64_t scale_d = (float64_t)(1ULL << N);                      /**< @brief Scale factor as float64. */
+    static constexpr float64_t f_max_d = (float64_t)(1ULL << (word_bits - 1U - N));   /**< @brief Same as F_MAXbxx_d(N). */
+
+    W raw;  /**< @brief Fixed-point word. */
+
+    constexpr fixed() : raw(0) {}
+    /** @brief Converts float32 with saturation, same as Qx_bxx(N, x). */
+    explicit constexpr fixed(float32_t x) : raw(encode(x)) {}
+    /** @brief Converts float64 with saturation, same as Qx_bxx_d(N, x). */
+    explicit constexpr fixed(float64_t x) : raw(encode_d(x)) {}
+
+    /** @brief Wraps an existing fixed-point word. */
+    static constexpr fixed from_raw(W r) { return fixed(r, 0); }
+
+    /** @brief Float32 to word with saturation, same as Qx_bxx(N, x). */
+    static constexpr W encode(float32_t x)
+    {
+        return x >= f_max ? q_max : (x < f_min ? q_min : static_cast<W>(x * scale));
+    }
+
+    /** @brief Float64 to word with saturation, same as Qx_bxx_d(N, x). */
+    static constexpr W encode_d(float64_t x)
+    {
+        return x >= f_max_d ? q_max : (x < -f_max_d ? q_min : static_cast<W>(x * scale_d));
+    }
+
+    /** @brief Word to float32, same as F_Qx_bxx(N, r). */
+    static constexpr float32_t decode(W r) { return (float32_t)r * (1.0f / scale); }
+
+    /** @brief Word to float64, same as F_Qx_bxx_d(N, r). */
+    static constexpr float64_t decode_d(W r) { return (float64_t)r * (1.0 / scale_d); }
+
+    constexpr float32_t to_float()  const { return decode(raw); }
+    constexpr float64_t to_double() const { return decode_d(raw); }
+
+    /** @brief Converts a list of floats to words, e.g. filter taps or a LUT. */
+    template <std::size_t K>
+    static constexpr std::array<W, K> table(const float32_t (&x)[K])
+    {
+        return table_(x, std::make_index_sequence<K>{});
+    }
+
+    /** @brief Same as table(), from float64 values. */
+    template <std::size_t K>
+    static constexpr std::array<W, K> table_d(const float64_t (&x)[K])
+    {
+        return table_d_(x, std::make_index_sequence<K>{});
+    }
+
+    friend constexpr bool operator==(fixed a, fixed b) { return a.raw == b.raw; }
+    friend constexpr bool operator!=(fixed a, fixed b) { return a.raw != b.raw; }
+    friend constexpr bool operator< (fixed a, fixed b) { return a.raw <  b.raw; }
+
+private:
+    constexpr fixed(W r, int) : raw(r) {}
+
+    template <std::size_t K, std::size_t... I>
+    static constexpr std::array<W, K> table_(const float32_t (&x)[K], std::index_sequence<I...>)
+    {
+        return {{ encode(x[I])... }};
+    }
+
+    template <std::size_t K, std::size_t... I>
+    static constexpr std::array<W, K> table_d_(const float64_t (&x)[K], std::index_sequence<I...>)
+    {
+        return {{ encode_d(x[I])... }};
+    }
+};
+
+#if __cplusplus < 201703L
+// Out-of-class definitions, needed before C++17 when a member is bound to a reference.
+template <typename W, unsigned int N> constexpr unsigned int fixed<W, N>::word_bits;
+template <typename W, unsigned int N> constexpr unsigned int fixed<W, N>::frac_bits;
+template <typename W, unsigned int N> constexpr W            fixed<W, N>::q_max;
+template <typename W, unsigned int N> constexpr W            fixed<W, N>::q_min;
+template <typename W, unsigned int N> constexpr float32_t    fixed<W, N>::scale;
+template <typename W, unsigned int N> constexpr float32_t    fixed<W, N>::f_max;
+template <typename W, unsigned int N> constexpr float32_t    fixed<W, N>::f_min;
+template <typename W, unsigned int N> constexpr float64_t    fixed<W, N>::scale_d;
+template <typename W, unsigned int N> constexpr float64_t    fixed<W, N>::f_max_d;
+#endif
+
+template <unsigned int N> using q8  = fixed<fix8_t,  N>;    /**< @brief 8-bit Qn. */
+template <unsigned int N> using q16 = fixed<fix16_t, N>;    /**< @brief 16-bit Qn. */
+template <unsigned int N> using q32 = fixed<fix32_t, N>;    /**< @brief 32-bit Qn. */
+template <unsigned int N> using q64 = fixed<fix64_t, N>;    /**< @brief 64-bit Qn. */
+
+using q7  = q8<7>;      /**< @brief 8-bit Q7. */
+using q15 = q16<15>;    /**< @brief 16-bit Q15. */
+using q31 = q32<31>;    /**< @brief 32-bit Q31. */
+using q63 = q64<63>;    /**< @brief 64-bit Q63. */
+
+} // namespace q
+
+
+#endif /* SRC_Q_FIXED_HPP_ */
@@ -0,0 +1,418 @@
+/**
+ * @file    q_half.h
+ * @brief   Half precision (fp16_t) and bfloat16 (bf16_t) input and output
+ *          for the Q array conversions.
+ *
+ *          Qx_bxx_array_h() / Qx_bxx_array_bf() quantize half / bfloat16
+ *          arrays, F_Qx_bxx_array_h() / F_Qx_bxx_array_bf() decode to them.
+ *          The input is widened (or the output narrowed) Q_HALF_BLOCK
+ *          elements at a time into a float32 block on the stack, which stays
+ *          in L1 and goes straight through the q_array.h kernels; no float32
+ *          array goes to memory. Every value is exactly representable as
+ *          float32, so Qx_b16_array_h(N, ...) gives the same words as
+ *          Qx_b16(N, q_f16_to_f32(h)); the decoders round F_Qx_bxx() to
+ *          nearest even.
+ *
+ *          Widening and narrowing use F16C (AVX2 tier) and the AVX-512 forms
+ *          for half, shifts for bfloat16, and plain bit manipulation in C
+ *          (q_f16_to_f32(), q_f32_to_f16(), ...), all with the same results,
+ *          NaN included.
+ *
+ *          @code
+ *          Q15_b16_array_h(out, act, n);               // fp16 activations to Q15
+ *          F_Qx_b16_array_bf(12, w, q, n);             // Q12 to bfloat16
+ *          @endcode
+ *
+ * @note    A half NaN becomes a quiet float32 NaN with the same payload, a
+ *          float32 NaN a quiet half / bfloat16 NaN with the top payload bits.
+ *          NaN input to the Q conversions is undefined as elsewhere.
+ */
+
+#ifndef SRC_Q_HALF_H_
+#define SRC_Q_HALF_H_
+
+
+#include "q_array.h"
+#include "q_macros.h"
+#include "q_simd.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifndef Q_HALF_BLOCK
+#define Q_HALF_BLOCK    512U        /**< Elements widened or narrowed per step, float32 block on the stack. */
+#endif
+
+
+// Scalar conversions
+
+/** @brief Half to float32, exact. */
+static inline float32_t q_f16_to_f32(fp16_t h)
+{
+    uint32_t  s = (uint32_t)(h & 0x8000U) << 16;
+    uint32_t  e = (h >> 10) & 0x1FU;
+    uint32_t  m = h & 0x3FFU;
+    uint32_t  u;
+    float32_t f;
+
+    if (e == 0x1FU)
+    {
+        u = s | 0x7F800000U | (m << 13) | (m != 0 ? 0x400000U : 0U);   /* Inf, quiet NaN. */
+    }
+    else if (e != 0)
+    {
+        u = s | ((e + 112U) << 23) | (m << 13);
+    }
+    else
+    {
+        f = (float32_t)m * (1.0f / 16777216.0f);                        /* Zero, subnormal: m 2^-24. */
+        memcpy(&u, &f, sizeof(u));
+        u |= s;
+    }
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+/** @brief Float32 to half, rounded to nearest even, overflow to Inf. */
+static inline fp16_t q_f32_to_f16(float32_t f)
+{
+    uint32_t u, a, s;
+
+    memcpy(&u, &f, sizeof(u));
+    s = (u >> 16) & 0x8000U;
+    a = u & 0x7FFFFFFFU;
+    if (a > 0x7F800000U)
+    {
+        return (fp16_t)(s | 0x7E00U | ((a >> 13) & 0x3FFU));
+    }
+    if (a >= 0x477FF000U)                   /* 65520 and up, Inf: round to Inf. */
+    {
+        return (fp16_t)(s | 0x7C00U);
+    }
+    if (a >= 0x38800000U)                   /* 2^-14 and up: normal, rebias and round. */
+    {
+        a -= 0x38000000U;
+        return (fp16_t)(s | ((a + 0xFFFU + ((a >> 13) & 1U)) >> 13));
+    }
+
+    /* Subnormal half: round m 2^(e-150) to units of 2^-24, m with the hidden bit. */
+    uint32_t sh = 126U - (a >> 23);
+    if (sh > 24U)
+    {
+        return (fp16_t)s;
+    }
+    uint32_t m    = (a & 0x7FFFFFU) | 0x800000U;
+    uint32_t q    = m >> sh;
+    uint32_t rem  = m & ((1U << sh) - 1U);
+    uint32_t half = 1U << (sh - 1U);
+    q += rem > half || (rem == half && (q & 1U));
+    return (fp16_t)(s | q);
+}
+
+/** @brief bfloat16 to float32, exact. */
+static inline float32_t q_bf16_to_f32(bf16_t h)
+{
+    uint32_t  u = (uint32_t)h << 16;
+    float32_t f;
+
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+/** @brief Float32 to bfloat16, rounded to nearest even, overflow to Inf. */
+static inline bf16_t q_f32_to_bf16(float32_t f)
+{
+    uint32_t u;
+
+    memcpy(&u, &f, sizeof(u));
+    if ((u & 0x7FFFFFFFU) > 0x7F800000U)
+    {
+        return (bf16_t)((u >> 16) | 0x40U);
+    }
+    return (bf16_t)((u + 0x7FFFU + ((u >> 16) & 1U)) >> 16);
+}
+
+
+// Plain C kernels
+
+static inline void q_f16_to_f32_c(float32_t *dst, const fp16_t *src, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        dst[i] = q_f16_to_f32(src[i]);
+    }
+}
+
+static inline void q_f32_to_f16_c(fp16_t *dst, const float32_t *src, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        dst[i] = q_f32_to_f16(src[i]);
+    }
+}
+
+static inline void q_bf16_to_f32_c(float32_t *dst, const bf16_t *src, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        dst[i] = q_bf16_to_f32(src[i]);
+    }
+}
+
+static inline void q_f32_to_bf16_c(bf16_t *dst, const float32_t *src, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        dst[i] = q_f32_to_bf16(src[i]);
+    }
+}
+
+
+#if Q_SIMD_AVX2
+Q_TARGET_AVX2_BEGIN
+
+static inline void q_f16_to_f32_avx2(float32_t *dst, const fp16_t *src, size_t n)
+{
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(src + i))));
+    }
+    q_f16_to_f32_c(dst + i, src + i, n - i);
+}
+
+static inline void q_f32_to_f16_avx2(fp16_t *dst, const float32_t *src, size_t n)
+{
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        _mm_storeu_si128((__m128i *)(dst + i), _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT));
+    }
+    q_f32_to_f16_c(dst + i, src + i, n - i);
+}
+
+static inline void q_bf16_to_f32_avx2(float32_t *dst, const bf16_t *src, size_t n)
+{
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i u = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(src + i)));
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_slli_epi32(u, 16));
+    }
+    q_bf16_to_f32_c(dst + i, src + i, n - i);
+}
+
+/* Same as q_f32_to_bf16(): add 0x7FFF plus the kept lsb, NaN quieted instead. */
+static inline __m256i q_f32_to_bf16_avx2_k(__m256 x)
+{
+    __m256i u   = _mm256_castps_si256(x);
+    __m256i r   = _mm256_add_epi32(u, _mm256_add_epi32(_mm256_set1_epi32(0x7FFF), _mm256_and_si256(_mm256_srli_epi32(u, 16), _mm256_set1_epi32(1))));
+    __m256i nan = _mm256_castps_si256(_mm256_cmp_ps(x, x, _CMP_UNORD_Q));
+    return _mm256_blendv_epi8(_mm256_srli_epi32(r, 16), _mm256_or_si256(_mm256_srli_epi32(u, 16), _mm256_set1_epi32(0x40)), nan);
+}
+
+static inline void q_f32_to_bf16_avx2(bf16_t *dst, const float32_t *src, size_t n)
+{
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m256i a = q_f32_to_bf16_avx2_k(_mm256_loadu_ps(src + i));
+        __m256i b = q_f32_to_bf16_avx2_k(_mm256_loadu_ps(src + i + 8));
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_permute4x64_epi64(_mm256_packus_epi32(a, b), 0xD8));
+    }
+    q_f32_to_bf16_c(dst + i, src + i, n - i);
+}
+
+Q_TARGET_END
+#endif /* Q_SIMD_AVX2 */
+
+
+#if Q_SIMD_AVX512
+Q_TARGET_AVX512_BEGIN
+
+static inline void q_f16_to_f32_avx512(float32_t *dst, const fp16_t *src, size_t n)
+{
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        _mm512_storeu_ps(dst + i, _mm512_cvtph_ps(_mm256_loadu_si256((const __m256i *)(src + i))));
+    }
+    q_f16_to_f32_c(dst + i, src + i, n - i);
+}
+
+static inline void q_f32_to_f16_avx512(fp16_t *dst, const float32_t *src, size_t n)
+{
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm512_cvtps_ph(_mm512_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT));
+    }
+    q_f32_to_f16_c(dst + i, src + i, n - i);
+}
+
+static inline void q_bf16_to_f32_avx512(float32_t *dst, const bf16_t *src, size_t n)
+{
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m512i u = _mm512_cvtepu16_epi32(_mm256_loadu_si256((const __m256i *)(src + i)));
+        _mm512_storeu_si512((void *)(dst + i), _mm512_slli_epi32(u, 16));
+    }
+    q_bf16_to_f32_c(dst + i, src + i, n - i);
+}
+
+static inline void q_f32_to_bf16_avx512(bf16_t *dst, const float32_t *src, size_t n)
+{
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m512    x   = _mm512_loadu_ps(src + i);
+        __m512i   u   = _mm512_castps_si512(x);
+        __m512i   r   = _mm512_add_epi32(u, _mm512_add_epi32(_mm512_set1_epi32(0x7FFF), _mm512_and_si512(_mm512_srli_epi32(u, 16), _mm512_set1_epi32(1))));
+        __mmask16 nan = _mm512_cmp_ps_mask(x, x, _CMP_UNORD_Q);
+        r = _mm512_mask_or_epi32(_mm512_srli_epi32(r, 16), nan, _mm512_srli_epi32(u, 16), _mm512_set1_epi32(0x40));
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm512_cvtepi32_epi16(r));
+    }
+    q_f32_to_bf16_c(dst + i, src + i, n - i);
+}
+
+Q_TARGET_END
+#endif /* Q_SIMD_AVX512 */
+
+
+// Kernel table, bound once per translation unit to the tier from q_isa().
+
+typedef struct
+{
+    void (*f16_to_f32)(float32_t *dst, const fp16_t *src, size_t n);
+    void (*f32_to_f16)(fp16_t *dst, const float32_t *src, size_t n);
+    void (*bf16_to_f32)(float32_t *dst, const bf16_t *src, size_t n);
+    void (*f32_to_bf16)(bf16_t *dst, const float32_t *src, size_t n);
+    int    bound;
+} q_half_fn_t;
+
+static q_half_fn_t q_half_k;
+
+/** @brief Fills q_half_k for q_isa(). Runs before main() where supported. @note RARELY USE DIRECTLY. */
+static Q_CONSTRUCTOR void q_half_bind(void)
+{
+    q_isa_t     isa = q_isa();
+    q_half_fn_t k   = { q_f16_to_f32_c, q_f32_to_f16_c, q_bf16_to_f32_c, q_f32_to_bf16_c, 1 };
+
+    (void)isa;
+#if Q_SIMD_AVX2
+    if (isa >= Q_ISA_AVX2)
+    {
+        k.f16_to_f32  = q_f16_to_f32_avx2;
+        k.f32_to_f16  = q_f32_to_f16_avx2;
+        k.bf16_to_f32 = q_bf16_to_f32_avx2;
+        k.f32_to_bf16 = q_f32_to_bf16_avx2;
+    }
+#endif
+#if Q_SIMD_AVX512
+    if (isa >= Q_ISA_AVX512)
+    {
+        k.f16_to_f32  = q_f16_to_f32_avx512;
+        k.f32_to_f16  = q_f32_to_f16_avx512;
+        k.bf16_to_f32 = q_bf16_to_f32_avx512;
+        k.f32_to_bf16 = q_f32_to_bf16_avx512;
+    }
+#endif
+    q_half_k = k;
+}
+
+/** @brief Bound kernel table. Binds on first use if the constructor has not run yet. @note RARELY USE DIRECTLY. */
+static inline const q_half_fn_t *q_half_fn(void)
+{
+    if (!q_half_k.bound)
+    {
+        q_half_bind();
+    }
+    return &q_half_k;
+}
+
+
+#define Q_HALF_ARRAY(W, T, H, SFX, WIDEN, NARROW)                                           \
+    /** @brief Qx_bxx_array() from H input. */                                              \
+    static inline void Qx_b##W##_array_##SFX(unsigned int N, T *dst, const H *src, size_t n) \
+    {                                                                                       \
+        float32_t buf[Q_HALF_BLOCK];                                                        \
+        for (size_t i = 0; i < n; i += Q_HALF_BLOCK)                                        \
+        {                                                                                   \
+            size_t m = n - i < Q_HALF_BLOCK ? n - i : Q_HALF_BLOCK;                         \
+            q_half_fn()->WIDEN(buf, src + i, m);                                            \
+            Qx_b##W##_array(N, dst + i, buf, m);                                            \
+        }                                                                                   \
+    }                                                                                       \
+    /** @brief F_Qx_bxx_array() to H output, rounded to nearest even. */                    \
+    static inline void F_Qx_b##W##_array_##SFX(unsigned int N, H *dst, const T *src, size_t n) \
+    {                                                                                       \
+        float32_t buf[Q_HALF_BLOCK];                                                        \
+        for (size_t i = 0; i < n; i += Q_HALF_BLOCK)                                        \
+        {                                                                                   \
+            size_t m = n - i < Q_HALF_BLOCK ? n - i : Q_HALF_BLOCK;                         \
+            F_Qx_b##W##_array(N, buf, src + i, m);                                          \
+            q_half_fn()->NARROW(dst + i, buf, m);                                           \
+        }                                                                                   \
+    }
+
+
+// Use this!
+
+/** @brief Half array to float32. */
+static inline void q_f16_to_f32_array(float32_t *dst, const fp16_t *src, size_t n)
+{
+    q_half_fn()->f16_to_f32(dst, src, n);
+}
+
+/** @brief Float32 array to half, rounded to nearest even. */
+static inline void q_f32_to_f16_array(fp16_t *dst, const float32_t *src, size_t n)
+{
+    q_half_fn()->f32_to_f16(dst, src, n);
+}
+
+/** @brief bfloat16 array to float32. */
+static inline void q_bf16_to_f32_array(float32_t *dst, const bf16_t *src, size_t n)
+{
+    q_half_fn()->bf16_to_f32(dst, src, n);
+}
+
+/** @brief Float32 array to bfloat16, rounded to nearest even. */
+static inline void q_f32_to_bf16_array(bf16_t *dst, const float32_t *src, size_t n)
+{
+    q_half_fn()->f32_to_bf16(dst, src, n);
+}
+
+Q_HALF_ARRAY(08, fix8_t,  fp16_t, h,  f16_to_f32,  f32_to_f16)
+Q_HALF_ARRAY(16, fix16_t, fp16_t, h,  f16_to_f32,  f32_to_f16)
+Q_HALF_ARRAY(32, fix32_t, fp16_t, h,  f16_to_f32,  f32_to_f16)
+Q_HALF_ARRAY(64, fix64_t, fp16_t, h,  f16_to_f32,  f32_to_f16)
+Q_HALF_ARRAY(08, fix8_t,  bf16_t, bf, bf16_to_f32, f32_to_bf16)
+Q_HALF_ARRAY(16, fix16_t, bf16_t, bf, bf16_to_f32, f32_to_bf16)
+Q_HALF_ARRAY(32, fix32_t, bf16_t, bf, bf16_to_f32, f32_to_bf16)
+Q_HALF_ARRAY(64, fix64_t, bf16_t, bf, bf16_to_f32, f32_to_bf16)
+
+// Most used formats.
+#define Q7_b8_array_h(dst, src, n)      Qx_b08_array_h( 7, dst, src, n)     /**< Converts half array to 8-bit Q7. */
+#define Q15_b16_array_h(dst, src, n)    Qx_b16_array_h(15, dst, src, n)     /**< Converts half array to 16-bit Q15. */
+#define Q31_b32_array_h(dst, src, n)    Qx_b32_array_h(31, dst, src, n)     /**< Converts half array to 32-bit Q31. */
+#define Q7_b8_array_bf(dst, src, n)     Qx_b08_array_bf( 7, dst, src, n)    /**< Converts bfloat16 array to 8-bit Q7. */
+#define Q15_b16_array_bf(dst, src, n)   Qx_b16_array_bf(15, dst, src, n)    /**< Converts bfloat16 array to 16-bit Q15. */
+#define Q31_b32_array_bf(dst, src, n)   Qx_b32_array_bf(31, dst, src, n)    /**< Converts bfloat16 array to 32-bit Q31. */
+#define F_Q7b8_array_h(dst, src, n)     F_Qx_b08_array_h( 7, dst, src, n)   /**< Converts 8-bit Q7 array to half. */
+#define F_Q15b16_array_h(dst, src, n)   F_Qx_b16_array_h(15, dst, src, n)   /**< Converts 16-bit Q15 array to half. */
+#define F_Q31b32_array_h(dst, src, n)   F_Qx_b32_array_h(31, dst, src, n)   /**< Converts 32-bit Q31 array to half. */
+#define F_Q7b8_array_bf(dst, src, n)    F_Qx_b08_array_bf( 7, dst, src, n)  /**< Converts 8-bit Q7 array to bfloat16. */
+#define F_Q15b16_array_bf(dst, src, n)  F_Qx_b16_array_bf(15, dst, src, n)  /**< Converts 16-bit Q15 array to bfloat16. */
+#define F_Q31b32_array_bf(dst, src, n)  F_Qx_b32_array_bf(31, dst, src, n)  /**< Converts 32-bit Q31 array to bfloat16. */
+
+
+#endif /* SRC_Q_HALF_H_ */
@@ -0,0 +1,239 @@
+/**
+ * @file    q_lut.h
+ * @brief   Table lookup decode of 8 and 16 bit Q formats to float.
+ *
+ *          A fix8_t has 256 values and a fix16_t 65,536, so the whole decode
+ *          fits in a table: q_lut8_t (1 KiB) and q_lut16_t (256 KiB). A table
+ *          may also hold a scale or any function of the value, so the decode
+ *          and that pass over the data become one lookup:
+ *
+ *          @code
+ *          static const q_lut8_t q7 = Q_LUT8(7);       // built at compile time
+ *          q_lut8_array(&q7, out, in, n);              // same as F_Qx_b08_array(7, ...)
+ *
+ *          q_lut8_t act;
+ *          q_lut8_init_map(&act, 5, my_sigmoid, NULL); // out[i] = my_sigmoid(F_Qx_b08(5, in[i]))
+ *          q_lut8_array(&act, out, in, n);
+ *          @endcode
+ *
+ *          Tables belong to the caller and are read only after init, so one
+ *          table can serve any number of threads. Build them once, outside
+ *          the hot loop. With AVX2 and AVX-512 the lookup is a gather.
+ *
+ * @note    For a plain decode, F_Qx_b08_array() / F_Qx_b16_array() are
+ *          usually as fast or faster (convert and multiply per vector, no
+ *          table in cache); the table pays off once a scale or function is
+ *          folded in. benchmark.c times both ("lut" rows).
+ */
+
+#ifndef SRC_Q_LUT_H_
+#define SRC_Q_LUT_H_
+
+
+#include "q_macros.h"
+#include "q_simd.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/** @brief Decode table of one 8-bit format, indexed by the word as unsigned. */
+typedef struct
+{
+    float32_t v[256];
+} q_lut8_t;
+
+/** @brief Decode table of one 16-bit format, indexed by the word as unsigned. 256 KiB, allocate it. */
+typedef struct
+{
+    float32_t v[65536];
+} q_lut16_t;
+
+/** @brief Table entry I of 8-bit Qn, plain decode. @note RARELY USE DIRECTLY. */
+#define Q_LUT8_E(N, I)      F_Qx_b08(N, (I) < 128 ? (I) : (I) - 256)
+#define Q_LUT8_4(N, I)      Q_LUT8_E(N, I), Q_LUT8_E(N, (I) + 1), Q_LUT8_E(N, (I) + 2), Q_LUT8_E(N, (I) + 3)
+#define Q_LUT8_16(N, I)     Q_LUT8_4(N, I), Q_LUT8_4(N, (I) + 4), Q_LUT8_4(N, (I) + 8), Q_LUT8_4(N, (I) + 12)
+#define Q_LUT8_64(N, I)     Q_LUT8_16(N, I), Q_LUT8_16(N, (I) + 16), Q_LUT8_16(N, (I) + 32), Q_LUT8_16(N, (I) + 48)
+
+/** @brief Initializer of a q_lut8_t for 8-bit Qn, constant expression. Same values as q_lut8_init(t, N, 1.0f). */
+#define Q_LUT8(N)           { { Q_LUT8_64(N, 0), Q_LUT8_64(N, 64), Q_LUT8_64(N, 128), Q_LUT8_64(N, 192) } }
+
+
+// Plain C kernels
+
+static inline void q_lut8_c(const q_lut8_t *t, float32_t *dst, const fix8_t *src, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        dst[i] = t->v[(uint8_t)src[i]];
+    }
+}
+
+static inline void q_lut16_c(const q_lut16_t *t, float32_t *dst, const fix16_t *src, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        dst[i] = t->v[(uint16_t)src[i]];
+    }
+}
+
+
+#if Q_SIMD_AVX2
+Q_TARGET_AVX2_BEGIN
+
+static inline void q_lut8_avx2(const q_lut8_t *t, float32_t *dst, const fix8_t *src, size_t n)
+{
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i b = _mm_loadu_si128((const __m128i *)(src + i));
+        _mm256_storeu_ps(dst + i,     _mm256_i32gather_ps(t->v, _mm256_cvtepu8_epi32(b), 4));
+        _mm256_storeu_ps(dst + i + 8, _mm256_i32gather_ps(t->v, _mm256_cvtepu8_epi32(_mm_srli_si128(b, 8)), 4));
+    }
+    q_lut8_c(t, dst + i, src + i, n - i);
+}
+
+static inline void q_lut16_avx2(const q_lut16_t *t, float32_t *dst, const fix16_t *src, size_t n)
+{
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128i w = _mm_loadu_si128((const __m128i *)(src + i));
+        _mm256_storeu_ps(dst + i, _mm256_i32gather_ps(t->v, _mm256_cvtepu16_epi32(w), 4));
+    }
+    q_lut16_c(t, dst + i, src + i, n - i);
+}
+
+Q_TARGET_END
+#endif /* Q_SIMD_AVX2 */
+
+
+#if Q_SIMD_AVX512
+Q_TARGET_AVX512_BEGIN
+
+static inline void q_lut8_avx512(const q_lut8_t *t, float32_t *dst, const fix8_t *src, size_t n)
+{
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i b = _mm_loadu_si128((const __m128i *)(src + i));
+        _mm512_storeu_ps(dst + i, _mm512_i32gather_ps(_mm512_cvtepu8_epi32(b), t->v, 4));
+    }
+    q_lut8_c(t, dst + i, src + i, n - i);
+}
+
+static inline void q_lut16_avx512(const q_lut16_t *t, float32_t *dst, const fix16_t *src, size_t n)
+{
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m256i w = _mm256_loadu_si256((const __m256i *)(src + i));
+        _mm512_storeu_ps(dst + i, _mm512_i32gather_ps(_mm512_cvtepu16_epi32(w), t->v, 4));
+    }
+    q_lut16_c(t, dst + i, src + i, n - i);
+}
+
+Q_TARGET_END
+#endif /* Q_SIMD_AVX512 */
+
+
+// Kernel table, bound once per translation unit to the tier from q_isa().
+
+typedef struct
+{
+    void (*b08)(const q_lut8_t *t, float32_t *dst, const fix8_t *src, size_t n);
+    void (*b16)(const q_lut16_t *t, float32_t *dst, const fix16_t *src, size_t n);
+    int    bound;
+} q_lut_fn_t;
+
+static q_lut_fn_t q_lut_k;
+
+/** @brief Fills q_lut_k for q_isa(). Runs before main() where supported. @note RARELY USE DIRECTLY. */
+static Q_CONSTRUCTOR void q_lut_bind(void)
+{
+    q_isa_t    isa = q_isa();
+    q_lut_fn_t k   = { q_lut8_c, q_lut16_c, 1 };
+
+    (void)isa;
+#if Q_SIMD_AVX2
+    if (isa >= Q_ISA_AVX2)
+    {
+        k.b08 = q_lut8_avx2;
+        k.b16 = q_lut16_avx2;
+    }
+#endif
+#if Q_SIMD_AVX512
+    if (isa >= Q_ISA_AVX512)
+    {
+        k.b08 = q_lut8_avx512;
+        k.b16 = q_lut16_avx512;
+    }
+#endif
+    q_lut_k = k;
+}
+
+/** @brief Bound kernel table. Binds on first use if the constructor has not run yet. @note RARELY USE DIRECTLY. */
+static inline const q_lut_fn_t *q_lut_fn(void)
+{
+    if (!q_lut_k.bound)
+    {
+        q_lut_bind();
+    }
+    return &q_lut_k;
+}
+
+
+// Use this!
+
+/** @brief Fills t with F_Qx_b08(N, x) * scale for every x. scale 1.0f gives exactly F_Qx_b08(). */
+static inline void q_lut8_init(q_lut8_t *t, unsigned int N, float32_t scale)
+{
+    for (int x = -128; x < 128; x++)
+    {
+        t->v[(uint8_t)x] = F_Qx_b08(N, x) * scale;
+    }
+}
+
+/** @brief Fills t with F_Qx_b16(N, x) * scale for every x. scale 1.0f gives exactly F_Qx_b16(). */
+static inline void q_lut16_init(q_lut16_t *t, unsigned int N, float32_t scale)
+{
+    for (int32_t x = -32768; x < 32768; x++)
+    {
+        t->v[(uint16_t)x] = F_Qx_b16(N, x) * scale;
+    }
+}
+
+/** @brief Fills t with map(F_Qx_b08(N, x), ctx) for every x. */
+static inline void q_lut8_init_map(q_lut8_t *t, unsigned int N, float32_t (*map)(float32_t x, void *ctx), void *ctx)
+{
+    for (int x = -128; x < 128; x++)
+    {
+        t->v[(uint8_t)x] = map(F_Qx_b08(N, x), ctx);
+    }
+}
+
+/** @brief Fills t with map(F_Qx_b16(N, x), ctx) for every x. */
+static inline void q_lut16_init_map(q_lut16_t *t, unsigned int N, float32_t (*map)(float32_t x, void *ctx), void *ctx)
+{
+    for (int32_t x = -32768; x < 32768; x++)
+    {
+        t->v[(uint16_t)x] = map(F_Qx_b16(N, x), ctx);
+    }
+}
+
+/** @brief dst[i] = t->v[src[i]] for an 8-bit table. */
+static inline void q_lut8_array(const q_lut8_t *t, float32_t *dst, const fix8_t *src, size_t n)
+{
+    q_lut_fn()->b08(t, dst, src, n);
+}
+
+/** @brief dst[i] = t->v[src[i]] for a 16-bit table. */
+static inline void q_lut16_array(const q_lut16_t *t, float32_t *dst, const fix16_t *src, size_t n)
+{
+    q_lut_fn()->b16(t, dst, src, n);
+}
+
+
+#endif /* SRC_Q_LUT_H_ */
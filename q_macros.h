@@ -244,15 +244,16 @@
 
 
 // Fixed to float
+// Multiplies by 1/2^N: exact power-of-two reciprocal, same result as dividing by 2^N.
 
 /** @brief Converts back from  8-bit fixed-point to floating-point. @note RARELY USE DIRECTLY. */
-#define F_Qx_b08(N,x)  ( (float32_t)(x)/(float32_t)(SCALE_FACTOR_08(N)) )
+#define F_Qx_b08(N,x)  ( (float32_t)(x)*( 1.0f/(float32_t)(SCALE_FACTOR_08(N)) ) )
 /** @brief Converts back from 16-bit fixed-point to floating-point. @note RARELY USE DIRECTLY. */
-#define F_Qx_b16(N,x)  ( (float32_t)(x)/(float32_t)(SCALE_FACTOR_16(N)) )
+#define F_Qx_b16(N,x)  ( (float32_t)(x)*( 1.0f/(float32_t)(SCALE_FACTOR_16(N)) ) )
 /** @brief Converts back from 32-bit fixed-point to floating-point. @note RARELY USE DIRECTLY. */
-#define F_Qx_b32(N,x)  ( (float32_t)(x)/(float32_t)(SCALE_FACTOR_32(N)) )
+#define F_Qx_b32(N,x)  ( (float32_t)(x)*( 1.0f/(float32_t)(SCALE_FACTOR_32(N)) ) )
 /** @brief Converts back from 64-bit fixed-point to floating-point. @note RARELY USE DIRECTLY. */
-#define F_Qx_b64(N,x)  ( (float32_t)(x)/(float32_t)(SCALE_FACTOR_64(N)) )
+#define F_Qx_b64(N,x)  ( (float32_t)(x)*( 1.0f/(float32_t)(SCALE_FACTOR_64(N)) ) )
 
 // 8-bit
 #define  F_Q7b8(x)  F_Qx_b08( 7,x) /**< Converts from 8-bit Q7 to float. */
@@ -351,4 +352,35 @@
 #define F_Q29b64(x) F_Qx_b64(29,x)
 // add more when needed.
 //... end 64-bit.
+
+// Float64 path for 32 and 64 bit words. Keeps all 53 mantissa bits instead of 24.
+
+#define F_MAXb32_d(N)      ( (float64_t)( 1UL  << (32-1-(N)) ) )        /* Max 32 bit positive value as float64. */
+#define F_MAXb64_d(N)      ( (float64_t)( 1ULL << (64-1-(N)) ) )        /* Max 64 bit positive value as float64. */
+
+#define F_MINb32_d(N)      ( -F_MAXb32_d(N) )                           /* Min 32 bit negative value as float64. */
+#define F_MINb64_d(N)      ( -F_MAXb64_d(N) )                           /* Min 64 bit negative value as float64. */
+
+/** @brief Converts from float64 to 32-bit fixed-point with saturation. @note RARELY USE DIRECTLY. */
+#define Qx_b32_d(N,x)      ( (float64_t)(x)>=F_MAXb32_d(N) ? Q_MAXb32 : ( (float64_t)(x)<F_MINb32_d(N) ? Q_MINb32 : (fix32_t)( (float64_t)(x)*(float64_t)SCALE_FACTOR_32(N) ) ) )
+/** @brief Converts from float64 to 64-bit fixed-point with saturation. @note RARELY USE DIRECTLY. */
+#define Qx_b64_d(N,x)      ( (float64_t)(x)>=F_MAXb64_d(N) ? Q_MAXb64 : ( (float64_t)(x)<F_MINb64_d(N) ? Q_MINb64 : (fix64_t)( (float64_t)(x)*(float64_t)SCALE_FACTOR_64(N) ) ) )
+
+/** @brief Converts back from 32-bit fixed-point to float64 (exact). @note RARELY USE DIRECTLY. */
+#define F_Qx_b32_d(N,x)    ( (float64_t)(x)*( 1.0/(float64_t)(SCALE_FACTOR_32(N)) ) )
+/** @brief Converts back from 64-bit fixed-point to float64 (rounded to 53 bits). @note RARELY USE DIRECTLY. */
+#define F_Qx_b64_d(N,x)    ( (float64_t)(x)*( 1.0/(float64_t)(SCALE_FACTOR_64(N)) ) )
+
+#define Q31_b32_d(x)   Qx_b32_d(31,x)   /**< Converts float64 to 32-bit Q31. */
+#define Q30_b32_d(x)   Qx_b32_d(30,x)   /**< Converts float64 to 32-bit Q30. */
+#define Q63_b64_d(x)   Qx_b64_d(63,x)   /**< Converts float64 to 64-bit Q63. */
+#define Q62_b64_d(x)   Qx_b64_d(62,x)   /**< Converts float64 to 64-bit Q62. */
+#define Q47_b64_d(x)   Qx_b64_d(47,x)   /**< Converts float64 to 64-bit Q47. */
+
+#define F_Q31b32_d(x)  F_Qx_b32_d(31,x) /**< Converts from 32-bit Q31 to float64. */
+#define F_Q30b32_d(x)  F_Qx_b32_d(30,x) /**< Converts from 32-bit Q30 to float64. */
+#define F_Q63b64_d(x)  F_Qx_b64_d(63,x) /**< Converts from 64-bit Q63 to float64. */
+#define F_Q62b64_d(x)  F_Qx_b64_d(62,x) /**< Converts from 64-bit Q62 to float64. */
+#define F_Q47b64_d(x)  F_Qx_b64_d(47,x) /**< Converts from 64-bit Q47 to float64. */
+
 #endif /* SRC_Q_MACROS_H_ */
@@ -0,0 +1,867 @@
+/**
+ * @file    q_math.h
+ * @brief   Integer-only sin, cos, atan2, sqrt, reciprocal and exp2 for Q15
+ *          (fix16_t) and Q31 (fix32_t).
+ *
+ *          Angles are in units of pi: Q15 x is the angle x * pi rad, so
+ *          -1 .. 1 covers a full turn and wraps like the integer does.
+ *          - Q15_sin(), Q15_cos(), Q31_sin(), Q31_cos(): minimax polynomial
+ *            on a quarter turn.
+ *          - Q15_atan2(y, x), Q31_atan2(y, x): CORDIC, angle of (x, y) in
+ *            -1 .. 1; atan2(0, 0) is 0.
+ *          - Qx_b16_sqrt(N, x), Qx_b32_sqrt(N, x): Qn to Qn, bit by bit,
+ *            correctly rounded; negative x gives 0.
+ *          - Qx_b16_recip(Ni, No, x), Qx_b32_recip(): 1/x from Q<Ni> to
+ *            Q<No>, correctly rounded; 1/0 is Q_MAXbxx.
+ *          - Qx_b16_exp2(Ni, No, x), Qx_b32_exp2(): 2^x from Q<Ni> to Q<No>,
+ *            minimax polynomial on the fraction, shifted by the integer part.
+ *
+ *          Results saturate to Q_MINbxx .. Q_MAXbxx like Qx_bxx(): sin(pi/2)
+ *          is Q_MAXb16, atan2(0, -1) is Q_MAXb16 (+pi), 2^x too large for
+ *          Q<No> is Q_MAXbxx.
+ *
+ *          Max error against the exact value, in units of the last place of
+ *          the result (measured over all 16-bit inputs, 4M random atan2 pairs
+ *          and 4M random 32-bit inputs, plus the sign/zero/limit cases):
+ *
+ *          | function       | Q15 / b16 | Q31 / b32 |
+ *          |----------------|-----------|-----------|
+ *          | sin, cos       | 1.1       | 1.1       |
+ *          | atan2          | 1.0       | 1.0       |
+ *          | sqrt, recip    | 0.5       | 0.5       |
+ *          | exp2           | 1.0       | 1.05      |
+ *
+ *          The _array forms do the same on arrays, bit-identical to the
+ *          scalar functions. The 16-bit ones (sin, cos, atan2, sqrt, exp2)
+ *          run 8 or 16 lanes with AVX2/AVX-512; the 32-bit ones and the
+ *          reciprocals (integer divide) are plain C loops.
+ *
+ *          @code
+ *          fix16_t s = Q15_sin(Q15(0.25f));            // sin(pi/4) = 0.7071 in Q15
+ *          Q15_atan2_array(phase, im, re, n);          // phase of n complex samples
+ *          @endcode
+ */
+
+#ifndef SRC_Q_MATH_H_
+#define SRC_Q_MATH_H_
+
+
+#include "q_macros.h"
+#include "q_simd.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/** @brief Clamps a to lo .. hi. @note RARELY USE DIRECTLY. */
+#define Q_MATH_CLAMP(a, lo, hi) ((a) > (hi) ? (hi) : (a) < (lo) ? (lo) : (a))
+
+
+// Constants. Polynomial coefficients are minimax fits, CORDIC tables atan(2^-i) / pi.
+
+/* sin(pi/2 z) = z (C1 - C3 z^2 + C5 z^4 + C7 z^6). C1 Q17, C3 Q16, C5, C7 Q18. */
+#define Q_SIN16_C1      205887
+#define Q_SIN16_C3      42329
+#define Q_SIN16_C5      20823
+#define Q_SIN16_C7      (-1136)
+
+/* sin(pi/2 z) = z (C1 - C3 z^2 + C5 z^4 + ... + C11 z^10). C1 Q33, C3 Q32, C5 .. C11 Q34. */
+#define Q_SIN32_C1      INT64_C(13493037703)
+#define Q_SIN32_C3      INT64_C(2774394651)
+#define Q_SIN32_C5      INT64_C(1369108196)
+#define Q_SIN32_C7      INT64_C(-80429558)
+#define Q_SIN32_C9      INT64_C(2752445)
+#define Q_SIN32_C11     INT64_C(-58701)
+
+/* 2^f = E0 + E1 f + ... + E5 f^5, f in [0, 1), Q16. */
+#define Q_EXP16_E0      65536
+#define Q_EXP16_E1      45427
+#define Q_EXP16_E2      15738
+#define Q_EXP16_E3      3661
+#define Q_EXP16_E4      586
+#define Q_EXP16_E5      124
+
+/* 2^(t + 1/2) = E0 + E1 t + ... + E8 t^8, t in [-1/2, 1/2), Q31. */
+static const int64_t q_exp32_e[9] =
+{
+    INT64_C(3037000500), INT64_C(2105088334), INT64_C(729568022), INT64_C(168566008), INT64_C(29210263),
+    INT64_C(4049370), INT64_C(467806), INT64_C(46497), INT64_C(4020)
+};
+
+#define Q_ATAN16_ITER   18      /**< CORDIC steps, Q15. */
+#define Q_ATAN32_ITER   34      /**< CORDIC steps, Q31. */
+
+/* atan(2^-i) / pi, pi = 2^30. */
+static const int32_t q_atan16_tab[Q_ATAN16_ITER] =
+{
+    268435456, 158466703, 83729454, 42502378, 21333666, 10677233, 5339919, 2670123, 1335082,
+    667543, 333772, 166886, 83443, 41722, 20861, 10430, 5215, 2608
+};
+
+/* atan(2^-i) / pi, pi = 2^62. */
+static const int64_t q_atan32_tab[Q_ATAN32_ITER] =
+{
+    INT64_C(1152921504606846976), INT64_C(680609306067436595), INT64_C(359615265290440519),
+    INT64_C(182546323762760974), INT64_C(91627395746647414), INT64_C(45858365146018108),
+    INT64_C(22934778241356565), INT64_C(11468088963375447), INT64_C(5734131974037915),
+    INT64_C(2867076923938204), INT64_C(1433539829095742), INT64_C(716770085439068),
+    INT64_C(358385064080945), INT64_C(179192534710649), INT64_C(89596267689097),
+    INT64_C(44798133886270), INT64_C(22399066948350), INT64_C(11199533474827),
+    INT64_C(5599766737495), INT64_C(2799883368758), INT64_C(1399941684380),
+    INT64_C(699970842190), INT64_C(349985421095), INT64_C(174992710548),
+    INT64_C(87496355274), INT64_C(43748177637), INT64_C(21874088818),
+    INT64_C(10937044409), INT64_C(5468522205), INT64_C(2734261102),
+    INT64_C(1367130551), INT64_C(683565276), INT64_C(341782638), INT64_C(170891319)
+};
+
+
+// Scalar kernels. The 16-bit ones use only 32-bit lane operations, the SIMD kernels repeat them step by step.
+
+/**
+ * @brief sin of phase u (65536 = full turn) in Q15, saturated.
+ *        The C3 term is always negative and C1 - C3 z^2 positive, so the two
+ *        widest products run unsigned with one more fraction bit.
+ *        @note RARELY USE DIRECTLY.
+ */
+static inline int32_t q_sin16_i32(uint32_t u)
+{
+    int32_t  q  = (int32_t)((u >> 14) & 3U);
+    int32_t  r  = (int32_t)(u & 0x3FFFU);
+    int32_t  z  = (q & 1) ? 16384 - r : r;                  /* Q14, 0 .. 1 of a quarter turn. */
+    int32_t  z2 = (z * z + (1 << 11)) >> 12;                /* Q16 */
+    int32_t  p  = Q_SIN16_C5 + ((Q_SIN16_C7 * z2 + (1 << 15)) >> 16);          /* Q18 */
+    uint32_t c3 = (uint32_t)(Q_SIN16_C3 - ((p * z2 + (1 << 17)) >> 18));       /* Q16, minus the C3 term */
+    uint32_t c1 = (uint32_t)Q_SIN16_C1 - ((c3 * (uint32_t)z2 + (1U << 14)) >> 15); /* Q17 */
+    int32_t  s  = (int32_t)((c1 * (uint32_t)z + (1U << 15)) >> 16);            /* Q15, 0 .. 32768 */
+
+    return (q & 2) ? -s : (s > Q_MAXb16 ? Q_MAXb16 : s);
+}
+
+/** @brief sin of phase u (2^32 = full turn) in Q31, saturated. Same steps as q_sin16_i32(). @note RARELY USE DIRECTLY. */
+static inline int32_t q_sin32_i64(uint32_t u)
+{
+    uint32_t q  = u >> 30;
+    int64_t  r  = (int64_t)(u & 0x3FFFFFFFU);
+    int64_t  z  = (q & 1U) ? (INT64_C(1) << 30) - r : r;   /* Q30 */
+    int64_t  z2 = (z * z + (INT64_C(1) << 27)) >> 28;       /* Q32 */
+    int64_t  p  = Q_SIN32_C11;                              /* Q34 */
+    uint64_t c3, c1;
+    int64_t  s;
+
+    p  = Q_SIN32_C9 + ((p * z2 + (INT64_C(1) << 31)) >> 32);
+    p  = Q_SIN32_C7 + ((p * z2 + (INT64_C(1) << 31)) >> 32);
+    p  = Q_SIN32_C5 + ((p * z2 + (INT64_C(1) << 31)) >> 32);
+    c3 = (uint64_t)(Q_SIN32_C3 - ((p * z2 + (INT64_C(1) << 33)) >> 34));                   /* Q32 */
+    c1 = (uint64_t)Q_SIN32_C1 - ((c3 * (uint64_t)z2 + (UINT64_C(1) << 30)) >> 31);        /* Q33 */
+    s  = (int64_t)((c1 * (uint64_t)z + (UINT64_C(1) << 31)) >> 32);                        /* Q31, 0 .. 2^31 */
+    return (q & 2U) ? (int32_t)-s : (int32_t)(s > Q_MAXb32 ? Q_MAXb32 : s);
+}
+
+/** @brief atan2 of 16-bit y, x in units of pi, Q15, saturated. @note RARELY USE DIRECTLY. */
+static inline int32_t q_atan16_i32(int32_t y, int32_t x)
+{
+    int32_t off = 0;
+    int32_t z   = 0;                /* pi = 2^30 */
+
+    if ((x | y) == 0)
+    {
+        return 0;
+    }
+    if (x < 0)                      /* Rotate by pi into the right half plane. */
+    {
+        off = y < 0 ? -(1 << 30) : (1 << 30);
+        x   = -x;
+        y   = -y;
+    }
+    x *= 1 << 14;
+    y *= 1 << 14;
+    for (int i = 0; i < Q_ATAN16_ITER; i++)
+    {
+        int32_t d  = y >> 31;       /* Rotate toward y = 0: -1 turns the step around, no branch. */
+        int32_t xs = ((x >> i) ^ d) - d;
+        int32_t ys = ((y >> i) ^ d) - d;
+        x += ys;
+        y -= xs;
+        z += (q_atan16_tab[i] ^ d) - d;
+    }
+    z = (off + z + (1 << 14)) >> 15;
+    return z > Q_MAXb16 ? Q_MAXb16 : z;
+}
+
+/** @brief atan2 of 32-bit y, x in units of pi, Q31, saturated. @note RARELY USE DIRECTLY. */
+static inline int32_t q_atan32_i64(int64_t y, int64_t x)
+{
+    int64_t off = 0;
+    int64_t z   = 0;                /* pi = 2^62 */
+
+    if ((x | y) == 0)
+    {
+        return 0;
+    }
+    if (x < 0)
+    {
+        off = y < 0 ? -(INT64_C(1) << 62) : (INT64_C(1) << 62);
+        x   = -x;
+        y   = -y;
+    }
+    x *= INT64_C(1) << 30;
+    y *= INT64_C(1) << 30;
+    for (int i = 0; i < Q_ATAN32_ITER; i++)
+    {
+        int64_t d  = y >> 63;
+        int64_t xs = ((x >> i) ^ d) - d;
+        int64_t ys = ((y >> i) ^ d) - d;
+        x += ys;
+        y -= xs;
+        z += (q_atan32_tab[i] ^ d) - d;
+    }
+    z = (off + z + (INT64_C(1) << 30)) >> 31;
+    return (int32_t)(z > Q_MAXb32 ? Q_MAXb32 : z);
+}
+
+/** @brief Rounded sqrt of v < 2^31, 16 steps. @note RARELY USE DIRECTLY. */
+static inline int32_t q_sqrt16_i32(int32_t v)
+{
+    int32_t r = 0;
+
+    for (int32_t b = 1 << 30; b != 0; b >>= 2)
+    {
+        int32_t t  = r + b;
+        int32_t ge = -(int32_t)(v >= t);    /* All ones if this bit is set. */
+        r  = (r >> 1) + (b & ge);
+        v -= t & ge;
+    }
+    return r + (v > r);
+}
+
+/** @brief Rounded sqrt of v < 2^63, 32 steps. @note RARELY USE DIRECTLY. */
+static inline int64_t q_sqrt32_i64(int64_t v)
+{
+    int64_t r = 0;
+
+    for (int64_t b = INT64_C(1) << 62; b != 0; b >>= 2)
+    {
+        int64_t t  = r + b;
+        int64_t ge = -(int64_t)(v >= t);
+        r  = (r >> 1) + (b & ge);
+        v -= t & ge;
+    }
+    return r + (v > r);
+}
+
+/**
+ * @brief 2^x for 16-bit Q<Ni> x, in Q<No>, saturated.
+ *        Mantissa 2^f is Q16 in [65536, 131072), shifted right by 16 - No - k.
+ *        @note RARELY USE DIRECTLY.
+ */
+static inline int32_t q_exp16_i32(int32_t x, int32_t Ni, int32_t No)
+{
+    int32_t f = (x & ((1 << Ni) - 1)) << (15 - Ni);         /* Q15 fraction */
+    int32_t k = x >> Ni;
+    int32_t m = Q_EXP16_E5;                                 /* Q16 */
+    int32_t s = 16 - No - k;
+
+    m = Q_EXP16_E4 + ((m * f + (1 << 14)) >> 15);
+    m = Q_EXP16_E3 + ((m * f + (1 << 14)) >> 15);
+    m = Q_EXP16_E2 + ((m * f + (1 << 14)) >> 15);
+    m = Q_EXP16_E1 + ((m * f + (1 << 14)) >> 15);
+    m = Q_EXP16_E0 + ((m * f + (1 << 14)) >> 15);
+    if (s <= 1)
+    {
+        return Q_MAXb16;            /* m >> 1 is already >= 2^15. */
+    }
+    return s > 31 ? 0 : Q_MATH_CLAMP((m + (1 << (s - 1))) >> s, 0, Q_MAXb16);
+}
+
+/** @brief 2^x for 32-bit Q<Ni> x, in Q<No>, saturated. Mantissa Q31 in [2^31, 2^32). @note RARELY USE DIRECTLY. */
+static inline int32_t q_exp32_i64(int64_t x, int32_t Ni, int32_t No)
+{
+    int64_t t = ((x & ((INT64_C(1) << Ni) - 1)) << (31 - Ni)) - (INT64_C(1) << 30);  /* Q31, -1/2 .. 1/2 */
+    int64_t k = x >> Ni;
+    int64_t m = q_exp32_e[8];
+    int64_t s = 31 - No - k;
+
+    for (int i = 7; i >= 0; i--)
+    {
+        m = q_exp32_e[i] + ((m * t + (INT64_C(1) << 30)) >> 31);
+    }
+    if (s <= 0)
+    {
+        return Q_MAXb32;            /* m >= 2^31. */
+    }
+    return s > 62 ? 0 : (int32_t)Q_MATH_CLAMP((m + (INT64_C(1) << (s - 1))) >> s, 0, Q_MAXb32);
+}
+
+
+// Plain C kernels for the 16-bit arrays. ph is 0 for sin, 16384 for cos.
+
+static inline void q_sin16_c(fix16_t *dst, const fix16_t *src, size_t n, uint32_t ph)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        dst[i] = (fix16_t)q_sin16_i32((uint16_t)src[i] + ph);
+    }
+}
+
+static inline void q_atan16_c(fix16_t *dst, const fix16_t *y, const fix16_t *x, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        dst[i] = (fix16_t)q_atan16_i32(y[i], x[i]);
+    }
+}
+
+static inline void q_sqrt16_c(unsigned int N, fix16_t *dst, const fix16_t *src, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        dst[i] = (fix16_t)(src[i] <= 0 ? 0 : q_sqrt16_i32((int32_t)src[i] << N));
+    }
+}
+
+static inline void q_exp16_c(unsigned int Ni, unsigned int No, fix16_t *dst, const fix16_t *src, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        dst[i] = (fix16_t)q_exp16_i32(src[i], (int32_t)Ni, (int32_t)No);
+    }
+}
+
+
+#if Q_SIMD_AVX2
+Q_TARGET_AVX2_BEGIN
+
+/* Lane versions of the scalar kernels, same steps. */
+
+static inline __m256i q_sin16_avx2(__m256i u)
+{
+    const __m256i one = _mm256_set1_epi32(1);
+    __m256i q  = _mm256_and_si256(_mm256_srli_epi32(u, 14), _mm256_set1_epi32(3));
+    __m256i r  = _mm256_and_si256(u, _mm256_set1_epi32(0x3FFF));
+    __m256i od = _mm256_cmpeq_epi32(_mm256_and_si256(q, one), one);
+    __m256i z  = _mm256_blendv_epi8(r, _mm256_sub_epi32(_mm256_set1_epi32(16384), r), od);
+    __m256i z2 = _mm256_srai_epi32(_mm256_add_epi32(_mm256_mullo_epi32(z, z), _mm256_set1_epi32(1 << 11)), 12);
+    __m256i p  = _mm256_add_epi32(_mm256_set1_epi32(Q_SIN16_C5), _mm256_srai_epi32(_mm256_add_epi32(
+                     _mm256_mullo_epi32(_mm256_set1_epi32(Q_SIN16_C7), z2), _mm256_set1_epi32(1 << 15)), 16));
+    __m256i c3 = _mm256_sub_epi32(_mm256_set1_epi32(Q_SIN16_C3), _mm256_srai_epi32(_mm256_add_epi32(
+                     _mm256_mullo_epi32(p, z2), _mm256_set1_epi32(1 << 17)), 18));
+    __m256i c1 = _mm256_sub_epi32(_mm256_set1_epi32(Q_SIN16_C1), _mm256_srli_epi32(_mm256_add_epi32(
+                     _mm256_mullo_epi32(c3, z2), _mm256_set1_epi32(1 << 14)), 15));
+    __m256i s  = _mm256_srli_epi32(_mm256_add_epi32(_mm256_mullo_epi32(c1, z), _mm256_set1_epi32(1 << 15)), 16);
+    __m256i ng = _mm256_cmpeq_epi32(_mm256_and_si256(q, _mm256_set1_epi32(2)), _mm256_set1_epi32(2));
+
+    return _mm256_blendv_epi8(_mm256_min_epi32(s, _mm256_set1_epi32(Q_MAXb16)),
+                              _mm256_sub_epi32(_mm256_setzero_si256(), s), ng);
+}
+
+static inline __m256i q_atan16_avx2(__m256i y, __m256i x)
+{
+    __m256i zero = _mm256_cmpeq_epi32(_mm256_or_si256(x, y), _mm256_setzero_si256());
+    __m256i neg  = _mm256_srai_epi32(x, 31);
+    __m256i off  = _mm256_and_si256(neg, _mm256_or_si256(_mm256_set1_epi32(1 << 30),
+                                                           _mm256_and_si256(_mm256_srai_epi32(y, 31), _mm256_set1_epi32(INT32_MIN))));
+    __m256i z    = _mm256_setzero_si256();
+
+    x = _mm256_slli_epi32(_mm256_sub_epi32(_mm256_xor_si256(x, neg), neg), 14);
+    y = _mm256_slli_epi32(_mm256_sub_epi32(_mm256_xor_si256(y, neg), neg), 14);
+    for (int i = 0; i < Q_ATAN16_ITER; i++)
+    {
+        __m128i sh = _mm_cvtsi32_si128(i);
+        __m256i d  = _mm256_srai_epi32(y, 31);
+        __m256i xs = _mm256_sub_epi32(_mm256_xor_si256(_mm256_sra_epi32(x, sh), d), d);
+        __m256i ys = _mm256_sub_epi32(_mm256_xor_si256(_mm256_sra_epi32(y, sh), d), d);
+        __m256i t  = _mm256_sub_epi32(_mm256_xor_si256(_mm256_set1_epi32(q_atan16_tab[i]), d), d);
+        x = _mm256_add_epi32(x, ys);
+        y = _mm256_sub_epi32(y, xs);
+        z = _mm256_add_epi32(z, t);
+    }
+    z = _mm256_srai_epi32(_mm256_add_epi32(_mm256_add_epi32(off, z), _mm256_set1_epi32(1 << 14)), 15);
+    return _mm256_andnot_si256(zero, _mm256_min_epi32(z, _mm256_set1_epi32(Q_MAXb16)));
+}
+
+static inline __m256i q_sqrt16_avx2(__m256i x, unsigned int N)
+{
+    __m256i v = _mm256_sll_epi32(_mm256_max_epi32(x, _mm256_setzero_si256()), _mm_cvtsi32_si128((int)N));
+    __m256i r = _mm256_setzero_si256();
+
+    for (int32_t b = 1 << 30; b != 0; b >>= 2)
+    {
+        __m256i t  = _mm256_add_epi32(r, _mm256_set1_epi32(b));
+        __m256i lt = _mm256_cmpgt_epi32(t, v);                  /* v < r + b */
+        r = _mm256_srli_epi32(r, 1);
+        v = _mm256_sub_epi32(v, _mm256_andnot_si256(lt, t));
+        r = _mm256_add_epi32(r, _mm256_andnot_si256(lt, _mm256_set1_epi32(b)));
+    }
+    return _mm256_sub_epi32(r, _mm256_cmpgt_epi32(v, r));
+}
+
+static inline __m256i q_exp16_avx2(__m256i x, unsigned int Ni, unsigned int No)
+{
+    const __m256i h = _mm256_set1_epi32(1 << 14);
+    __m256i f = _mm256_sll_epi32(_mm256_and_si256(x, _mm256_set1_epi32((1 << Ni) - 1)), _mm_cvtsi32_si128(15 - (int)Ni));
+    __m256i k = _mm256_sra_epi32(x, _mm_cvtsi32_si128((int)Ni));
+    __m256i s = _mm256_sub_epi32(_mm256_set1_epi32(16 - (int)No), k);
+    __m256i m = _mm256_set1_epi32(Q_EXP16_E5);
+    __m256i r;
+
+    m = _mm256_add_epi32(_mm256_set1_epi32(Q_EXP16_E4), _mm256_srai_epi32(_mm256_add_epi32(_mm256_mullo_epi32(m, f), h), 15));
+    m = _mm256_add_epi32(_mm256_set1_epi32(Q_EXP16_E3), _mm256_srai_epi32(_mm256_add_epi32(_mm256_mullo_epi32(m, f), h), 15));
+    m = _mm256_add_epi32(_mm256_set1_epi32(Q_EXP16_E2), _mm256_srai_epi32(_mm256_add_epi32(_mm256_mullo_epi32(m, f), h), 15));
+    m = _mm256_add_epi32(_mm256_set1_epi32(Q_EXP16_E1), _mm256_srai_epi32(_mm256_add_epi32(_mm256_mullo_epi32(m, f), h), 15));
+    m = _mm256_add_epi32(_mm256_set1_epi32(Q_EXP16_E0), _mm256_srai_epi32(_mm256_add_epi32(_mm256_mullo_epi32(m, f), h), 15));
+    /* Shift counts above 31 give 0, as in the scalar code; s <= 1 saturates. */
+    r = _mm256_srlv_epi32(_mm256_add_epi32(m, _mm256_sllv_epi32(_mm256_set1_epi32(1), _mm256_sub_epi32(s, _mm256_set1_epi32(1)))), s);
+    r = _mm256_min_epi32(r, _mm256_set1_epi32(Q_MAXb16));
+    return _mm256_blendv_epi8(r, _mm256_set1_epi32(Q_MAXb16), _mm256_cmpgt_epi32(_mm256_set1_epi32(2), s));
+}
+
+/* 16 fix16_t in, two 8-lane halves out; and back, saturating. */
+static inline void q_load16_i32_avx2(__m256i v[2], const fix16_t *s)
+{
+    v[0] = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)s));
+    v[1] = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(s + 8)));
+}
+
+static inline void q_store16_i32_avx2(fix16_t *d, __m256i a, __m256i b)
+{
+    _mm256_storeu_si256((__m256i *)d, _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xD8));
+}
+
+static inline void q_sin16_avx2_k(fix16_t *dst, const fix16_t *src, size_t n, uint32_t ph)
+{
+    const __m256i m16 = _mm256_set1_epi32(0xFFFF);
+    const __m256i p   = _mm256_set1_epi32((int)ph);
+    size_t        i   = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m256i v[2];
+        q_load16_i32_avx2(v, src + i);
+        q_store16_i32_avx2(dst + i, q_sin16_avx2(_mm256_add_epi32(_mm256_and_si256(v[0], m16), p)),
+                                    q_sin16_avx2(_mm256_add_epi32(_mm256_and_si256(v[1], m16), p)));
+    }
+    q_sin16_c(dst + i, src + i, n - i, ph);
+}
+
+static inline void q_atan16_avx2_k(fix16_t *dst, const fix16_t *y, const fix16_t *x, size_t n)
+{
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m256i vy[2], vx[2];
+        q_load16_i32_avx2(vy, y + i);
+        q_load16_i32_avx2(vx, x + i);
+        q_store16_i32_avx2(dst + i, q_atan16_avx2(vy[0], vx[0]), q_atan16_avx2(vy[1], vx[1]));
+    }
+    q_atan16_c(dst + i, y + i, x + i, n - i);
+}
+
+static inline void q_sqrt16_avx2_k(unsigned int N, fix16_t *dst, const fix16_t *src, size_t n)
+{
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m256i v[2];
+        q_load16_i32_avx2(v, src + i);
+        q_store16_i32_avx2(dst + i, q_sqrt16_avx2(v[0], N), q_sqrt16_avx2(v[1], N));
+    }
+    q_sqrt16_c(N, dst + i, src + i, n - i);
+}
+
+static inline void q_exp16_avx2_k(unsigned int Ni, unsigned int No, fix16_t *dst, const fix16_t *src, size_t n)
+{
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m256i v[2];
+        q_load16_i32_avx2(v, src + i);
+        q_store16_i32_avx2(dst + i, q_exp16_avx2(v[0], Ni, No), q_exp16_avx2(v[1], Ni, No));
+    }
+    q_exp16_c(Ni, No, dst + i, src + i, n - i);
+}
+
+Q_TARGET_END
+#endif /* Q_SIMD_AVX2 */
+
+
+#if Q_SIMD_AVX512
+Q_TARGET_AVX512_BEGIN
+
+static inline __m512i q_sin16_avx512(__m512i u)
+{
+    __m512i   q  = _mm512_and_si512(_mm512_srli_epi32(u, 14), _mm512_set1_epi32(3));
+    __m512i   r  = _mm512_and_si512(u, _mm512_set1_epi32(0x3FFF));
+    __mmask16 od = _mm512_test_epi32_mask(q, _mm512_set1_epi32(1));
+    __mmask16 ng = _mm512_test_epi32_mask(q, _mm512_set1_epi32(2));
+    __m512i   z  = _mm512_mask_sub_epi32(r, od, _mm512_set1_epi32(16384), r);
+    __m512i   z2 = _mm512_srai_epi32(_mm512_add_epi32(_mm512_mullo_epi32(z, z), _mm512_set1_epi32(1 << 11)), 12);
+    __m512i   p  = _mm512_add_epi32(_mm512_set1_epi32(Q_SIN16_C5), _mm512_srai_epi32(_mm512_add_epi32(
+                       _mm512_mullo_epi32(_mm512_set1_epi32(Q_SIN16_C7), z2), _mm512_set1_epi32(1 << 15)), 16));
+    __m512i   c3 = _mm512_sub_epi32(_mm512_set1_epi32(Q_SIN16_C3), _mm512_srai_epi32(_mm512_add_epi32(
+                       _mm512_mullo_epi32(p, z2), _mm512_set1_epi32(1 << 17)), 18));
+    __m512i   c1 = _mm512_sub_epi32(_mm512_set1_epi32(Q_SIN16_C1), _mm512_srli_epi32(_mm512_add_epi32(
+                       _mm512_mullo_epi32(c3, z2), _mm512_set1_epi32(1 << 14)), 15));
+    __m512i   s  = _mm512_srli_epi32(_mm512_add_epi32(_mm512_mullo_epi32(c1, z), _mm512_set1_epi32(1 << 15)), 16);
+
+    return _mm512_mask_sub_epi32(_mm512_min_epi32(s, _mm512_set1_epi32(Q_MAXb16)), ng, _mm512_setzero_si512(), s);
+}
+
+static inline __m512i q_atan16_avx512(__m512i y, __m512i x)
+{
+    __mmask16 zero = _mm512_testn_epi32_mask(_mm512_or_si512(x, y), _mm512_set1_epi32(-1));
+    __mmask16 neg  = _mm512_cmplt_epi32_mask(x, _mm512_setzero_si512());
+    __mmask16 yneg = _mm512_cmplt_epi32_mask(y, _mm512_setzero_si512());
+    __m512i   off  = _mm512_maskz_mov_epi32(neg, _mm512_mask_blend_epi32(yneg, _mm512_set1_epi32(1 << 30),
+                                                                           _mm512_set1_epi32(-(1 << 30))));
+    __m512i   z    = _mm512_setzero_si512();
+
+    x = _mm512_slli_epi32(_mm512_mask_sub_epi32(x, neg, _mm512_setzero_si512(), x), 14);
+    y = _mm512_slli_epi32(_mm512_mask_sub_epi32(y, neg, _mm512_setzero_si512(), y), 14);
+    for (int i = 0; i < Q_ATAN16_ITER; i++)
+    {
+        __m128i   sh = _mm_cvtsi32_si128(i);
+        __mmask16 d  = _mm512_cmplt_epi32_mask(y, _mm512_setzero_si512());
+        __m512i   xs = _mm512_sra_epi32(x, sh);
+        __m512i   ys = _mm512_sra_epi32(y, sh);
+        __m512i   t  = _mm512_set1_epi32(q_atan16_tab[i]);
+        x = _mm512_mask_sub_epi32(_mm512_add_epi32(x, ys), d, x, ys);
+        y = _mm512_mask_add_epi32(_mm512_sub_epi32(y, xs), d, y, xs);
+        z = _mm512_mask_sub_epi32(_mm512_add_epi32(z, t), d, z, t);
+    }
+    z = _mm512_srai_epi32(_mm512_add_epi32(_mm512_add_epi32(off, z), _mm512_set1_epi32(1 << 14)), 15);
+    return _mm512_maskz_mov_epi32((__mmask16)~zero, _mm512_min_epi32(z, _mm512_set1_epi32(Q_MAXb16)));
+}
+
+static inline __m512i q_sqrt16_avx512(__m512i x, unsigned int N)
+{
+    __m512i v = _mm512_sll_epi32(_mm512_max_epi32(x, _mm512_setzero_si512()), _mm_cvtsi32_si128((int)N));
+    __m512i r = _mm512_setzero_si512();
+
+    for (int32_t b = 1 << 30; b != 0; b >>= 2)
+    {
+        __m512i   t  = _mm512_add_epi32(r, _mm512_set1_epi32(b));
+        __mmask16 ge = _mm512_cmpge_epi32_mask(v, t);
+        r = _mm512_srli_epi32(r, 1);
+        v = _mm512_mask_sub_epi32(v, ge, v, t);
+        r = _mm512_mask_add_epi32(r, ge, r, _mm512_set1_epi32(b));
+    }
+    return _mm512_mask_add_epi32(r, _mm512_cmpgt_epi32_mask(v, r), r, _mm512_set1_epi32(1));
+}
+
+static inline __m512i q_exp16_avx512(__m512i x, unsigned int Ni, unsigned int No)
+{
+    const __m512i h = _mm512_set1_epi32(1 << 14);
+    __m512i f = _mm512_sll_epi32(_mm512_and_si512(x, _mm512_set1_epi32((1 << Ni) - 1)), _mm_cvtsi32_si128(15 - (int)Ni));
+    __m512i k = _mm512_sra_epi32(x, _mm_cvtsi32_si128((int)Ni));
+    __m512i s = _mm512_sub_epi32(_mm512_set1_epi32(16 - (int)No), k);
+    __m512i m = _mm512_set1_epi32(Q_EXP16_E5);
+    __m512i r;
+
+    m = _mm512_add_epi32(_mm512_set1_epi32(Q_EXP16_E4), _mm512_srai_epi32(_mm512_add_epi32(_mm512_mullo_epi32(m, f), h), 15));
+    m = _mm512_add_epi32(_mm512_set1_epi32(Q_EXP16_E3), _mm512_srai_epi32(_mm512_add_epi32(_mm512_mullo_epi32(m, f), h), 15));
+    m = _mm512_add_epi32(_mm512_set1_epi32(Q_EXP16_E2), _mm512_srai_epi32(_mm512_add_epi32(_mm512_mullo_epi32(m, f), h), 15));
+    m = _mm512_add_epi32(_mm512_set1_epi32(Q_EXP16_E1), _mm512_srai_epi32(_mm512_add_epi32(_mm512_mullo_epi32(m, f), h), 15));
+    m = _mm512_add_epi32(_mm512_set1_epi32(Q_EXP16_E0), _mm512_srai_epi32(_mm512_add_epi32(_mm512_mullo_epi32(m, f), h), 15));
+    r = _mm512_srlv_epi32(_mm512_add_epi32(m, _mm512_sllv_epi32(_mm512_set1_epi32(1), _mm512_sub_epi32(s, _mm512_set1_epi32(1)))), s);
+    r = _mm512_min_epi32(r, _mm512_set1_epi32(Q_MAXb16));
+    return _mm512_mask_mov_epi32(r, _mm512_cmplt_epi32_mask(s, _mm512_set1_epi32(2)), _mm512_set1_epi32(Q_MAXb16));
+}
+
+/* 16 fix16_t in as 16 lanes; and back, saturating. */
+static inline __m512i q_load16_i32_avx512(const fix16_t *s)
+{
+    return _mm512_cvtepi16_epi32(_mm256_loadu_si256((const __m256i *)s));
+}
+
+static inline void q_store16_i32_avx512(fix16_t *d, __m512i v)
+{
+    _mm256_storeu_si256((__m256i *)d, _mm512_cvtsepi32_epi16(v));
+}
+
+static inline void q_sin16_avx512_k(fix16_t *dst, const fix16_t *src, size_t n, uint32_t ph)
+{
+    const __m512i m16 = _mm512_set1_epi32(0xFFFF);
+    const __m512i p   = _mm512_set1_epi32((int)ph);
+    size_t        i   = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m512i u = _mm512_add_epi32(_mm512_and_si512(q_load16_i32_avx512(src + i), m16), p);
+        q_store16_i32_avx512(dst + i, q_sin16_avx512(u));
+    }
+    q_sin16_c(dst + i, src + i, n - i, ph);
+}
+
+static inline void q_atan16_avx512_k(fix16_t *dst, const fix16_t *y, const fix16_t *x, size_t n)
+{
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        q_store16_i32_avx512(dst + i, q_atan16_avx512(q_load16_i32_avx512(y + i), q_load16_i32_avx512(x + i)));
+    }
+    q_atan16_c(dst + i, y + i, x + i, n - i);
+}
+
+static inline void q_sqrt16_avx512_k(unsigned int N, fix16_t *dst, const fix16_t *src, size_t n)
+{
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        q_store16_i32_avx512(dst + i, q_sqrt16_avx512(q_load16_i32_avx512(src + i), N));
+    }
+    q_sqrt16_c(N, dst + i, src + i, n - i);
+}
+
+static inline void q_exp16_avx512_k(unsigned int Ni, unsigned int No, fix16_t *dst, const fix16_t *src, size_t n)
+{
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        q_store16_i32_avx512(dst + i, q_exp16_avx512(q_load16_i32_avx512(src + i), Ni, No));
+    }
+    q_exp16_c(Ni, No, dst + i, src + i, n - i);
+}
+
+Q_TARGET_END
+#endif /* Q_SIMD_AVX512 */
+
+
+// Kernel table for the 16-bit arrays, bound once per translation unit to the tier from q_isa().
+
+typedef struct
+{
+    void (*sin16)(fix16_t *dst, const fix16_t *src, size_t n, uint32_t ph);
+    void (*atan16)(fix16_t *dst, const fix16_t *y, const fix16_t *x, size_t n);
+    void (*sqrt16)(unsigned int N, fix16_t *dst, const fix16_t *src, size_t n);
+    void (*exp16)(unsigned int Ni, unsigned int No, fix16_t *dst, const fix16_t *src, size_t n);
+    int    bound;
+} q_math_fn_t;
+
+static q_math_fn_t q_math_k;
+
+/** @brief Fills q_math_k for q_isa(). Runs before main() where supported. @note RARELY USE DIRECTLY. */
+static Q_CONSTRUCTOR void q_math_bind(void)
+{
+    q_isa_t     isa = q_isa();
+    q_math_fn_t k   = { q_sin16_c, q_atan16_c, q_sqrt16_c, q_exp16_c, 1 };
+
+    (void)isa;
+#if Q_SIMD_AVX2
+    if (isa >= Q_ISA_AVX2)
+    {
+        k.sin16  = q_sin16_avx2_k;
+        k.atan16 = q_atan16_avx2_k;
+        k.sqrt16 = q_sqrt16_avx2_k;
+        k.exp16  = q_exp16_avx2_k;
+    }
+#endif
+#if Q_SIMD_AVX512
+    if (isa >= Q_ISA_AVX512)
+    {
+        k.sin16  = q_sin16_avx512_k;
+        k.atan16 = q_atan16_avx512_k;
+        k.sqrt16 = q_sqrt16_avx512_k;
+        k.exp16  = q_exp16_avx512_k;
+    }
+#endif
+    q_math_k = k;
+}
+
+/** @brief Bound kernel table. Binds on first use if the constructor has not run yet. @note RARELY USE DIRECTLY. */
+static inline const q_math_fn_t *q_math_fn(void)
+{
+    if (!q_math_k.bound)
+    {
+        q_math_bind();
+    }
+    return &q_math_k;
+}
+
+
+// Use this!
+
+/** @brief sin(x pi) in Q15, x in Q15. */
+static inline fix16_t Q15_sin(fix16_t x)
+{
+    return (fix16_t)q_sin16_i32((uint16_t)x);
+}
+
+/** @brief cos(x pi) in Q15, x in Q15. */
+static inline fix16_t Q15_cos(fix16_t x)
+{
+    return (fix16_t)q_sin16_i32((uint16_t)x + 16384U);
+}
+
+/** @brief sin(x pi) in Q31, x in Q31. */
+static inline fix32_t Q31_sin(fix32_t x)
+{
+    return (fix32_t)q_sin32_i64((uint32_t)x);
+}
+
+/** @brief cos(x pi) in Q31, x in Q31. */
+static inline fix32_t Q31_cos(fix32_t x)
+{
+    return (fix32_t)q_sin32_i64((uint32_t)x + 0x40000000U);
+}
+
+/** @brief Angle of (x, y) in units of pi, Q15. y and x in any common 16-bit format. */
+static inline fix16_t Q15_atan2(fix16_t y, fix16_t x)
+{
+    return (fix16_t)q_atan16_i32(y, x);
+}
+
+/** @brief Angle of (x, y) in units of pi, Q31. y and x in any common 32-bit format. */
+static inline fix32_t Q31_atan2(fix32_t y, fix32_t x)
+{
+    return (fix32_t)q_atan32_i64(y, x);
+}
+
+/** @brief sqrt(x), 16-bit Qn to Qn, rounded. x < 0 gives 0. */
+static inline fix16_t Qx_b16_sqrt(unsigned int N, fix16_t x)
+{
+    return (fix16_t)(x <= 0 ? 0 : q_sqrt16_i32((int32_t)x << N));
+}
+
+/** @brief sqrt(x), 32-bit Qn to Qn, rounded. x < 0 gives 0. */
+static inline fix32_t Qx_b32_sqrt(unsigned int N, fix32_t x)
+{
+    return (fix32_t)(x <= 0 ? 0 : Q_MATH_CLAMP(q_sqrt32_i64((int64_t)x << N), 0, Q_MAXb32));
+}
+
+/** @brief 1/x, 16-bit Q<Ni> to Q<No>, rounded, saturated. 1/0 is Q_MAXb16. */
+static inline fix16_t Qx_b16_recip(unsigned int Ni, unsigned int No, fix16_t x)
+{
+    int32_t a = x < 0 ? -(int32_t)x : x;
+    int64_t r = a == 0 ? Q_MAXb16 : ((INT64_C(1) << (Ni + No)) + a / 2) / a;
+
+    return (fix16_t)(x < 0 ? Q_MATH_CLAMP(-r, Q_MINb16, 0) : Q_MATH_CLAMP(r, 0, Q_MAXb16));
+}
+
+/** @brief 1/x, 32-bit Q<Ni> to Q<No>, rounded, saturated. 1/0 is Q_MAXb32. */
+static inline fix32_t Qx_b32_recip(unsigned int Ni, unsigned int No, fix32_t x)
+{
+    int64_t a = x < 0 ? -(int64_t)x : x;
+    int64_t r = a == 0 ? Q_MAXb32 : (int64_t)(((UINT64_C(1) << (Ni + No)) + (uint64_t)a / 2U) / (uint64_t)a);
+
+    return (fix32_t)(x < 0 ? Q_MATH_CLAMP(-r, Q_MINb32, 0) : Q_MATH_CLAMP(r, 0, Q_MAXb32));
+}
+
+/** @brief 2^x, 16-bit Q<Ni> to Q<No>, saturated. */
+static inline fix16_t Qx_b16_exp2(unsigned int Ni, unsigned int No, fix16_t x)
+{
+    return (fix16_t)q_exp16_i32(x, (int32_t)Ni, (int32_t)No);
+}
+
+/** @brief 2^x, 32-bit Q<Ni> to Q<No>, saturated. */
+static inline fix32_t Qx_b32_exp2(unsigned int Ni, unsigned int No, fix32_t x)
+{
+    return (fix32_t)q_exp32_i64(x, (int32_t)Ni, (int32_t)No);
+}
+
+/** @brief Q15_sin() on n values. */
+static inline void Q15_sin_array(fix16_t *dst, const fix16_t *src, size_t n)
+{
+    q_math_fn()->sin16(dst, src, n, 0U);
+}
+
+/** @brief Q15_cos() on n values. */
+static inline void Q15_cos_array(fix16_t *dst, const fix16_t *src, size_t n)
+{
+    q_math_fn()->sin16(dst, src, n, 16384U);
+}
+
+/** @brief Q15_atan2(y[i], x[i]) on n pairs. */
+static inline void Q15_atan2_array(fix16_t *dst, const fix16_t *y, const fix16_t *x, size_t n)
+{
+    q_math_fn()->atan16(dst, y, x, n);
+}
+
+/** @brief Qx_b16_sqrt() on n values. */
+static inline void Qx_b16_sqrt_array(unsigned int N, fix16_t *dst, const fix16_t *src, size_t n)
+{
+    q_math_fn()->sqrt16(N, dst, src, n);
+}
+
+/** @brief Qx_b16_exp2() on n values. */
+static inline void Qx_b16_exp2_array(unsigned int Ni, unsigned int No, fix16_t *dst, const fix16_t *src, size_t n)
+{
+    q_math_fn()->exp16(Ni, No, dst, src, n);
+}
+
+/** @brief Qx_b16_recip() on n values. */
+static inline void Qx_b16_recip_array(unsigned int Ni, unsigned int No, fix16_t *dst, const fix16_t *src, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        dst[i] = Qx_b16_recip(Ni, No, src[i]);
+    }
+}
+
+/** @brief Q31_sin() on n values. */
+static inline void Q31_sin_array(fix32_t *dst, const fix32_t *src, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        dst[i] = Q31_sin(src[i]);
+    }
+}
+
+/** @brief Q31_cos() on n values. */
+static inline void Q31_cos_array(fix32_t *dst, const fix32_t *src, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        dst[i] = Q31_cos(src[i]);
+    }
+}
+
+/** @brief Q31_atan2(y[i], x[i]) on n pairs. */
+static inline void Q31_atan2_array(fix32_t *dst, const fix32_t *y, const fix32_t *x, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        dst[i] = Q31_atan2(y[i], x[i]);
+    }
+}
+
+/** @brief Qx_b32_sqrt() on n values. */
+static inline void Qx_b32_sqrt_array(unsigned int N, fix32_t *dst, const fix32_t *src, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        dst[i] = Qx_b32_sqrt(N, src[i]);
+    }
+}
+
+/** @brief Qx_b32_exp2() on n values. */
+static inline void Qx_b32_exp2_array(unsigned int Ni, unsigned int No, fix32_t *dst, const fix32_t *src, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        dst[i] = Qx_b32_exp2(Ni, No, src[i]);
+    }
+}
+
+/** @brief Qx_b32_recip() on n values. */
+static inline void Qx_b32_recip_array(unsigned int Ni, unsigned int No, fix32_t *dst, const fix32_t *src, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        dst[i] = Qx_b32_recip(Ni, No, src[i]);
+    }
+}
+
+
+// Most used formats.
+
+#define Q15_sqrt(x)                     Qx_b16_sqrt(15, x)                  /**< sqrt of Q15. */
+#define Q31_sqrt(x)                     Qx_b32_sqrt(31, x)                  /**< sqrt of Q31. */
+#define Q15_sqrt_array(dst, src, n)     Qx_b16_sqrt_array(15, dst, src, n)  /**< sqrt of Q15 array. */
+#define Q31_sqrt_array(dst, src, n)     Qx_b32_sqrt_array(31, dst, src, n)  /**< sqrt of Q31 array. */
+
+
+#endif /* SRC_Q_MATH_H_ */
@@ -0,0 +1,330 @@
+/**
+ * @file    q_pack.h
+ * @brief   Packed 4-bit and 2-bit signed fixed point arrays.
+ *
+ *          A 4-bit word holds -8 .. 7 (Q0 .. Q3), a 2-bit word -2 .. 1
+ *          (Q0, Q1). Two 4-bit words share a fix4x2_t and four 2-bit words a
+ *          fix2x4_t, element 0 in the low bits, so a Q3 array takes half the
+ *          bytes of Qx_b08(3, x) and a Q1 array a quarter.
+ *
+ *          Qx_b04(N, x) / Qx_b02(N, x) quantize like Qx_b08(): truncate,
+ *          saturate at F_MAXbxx(N) and F_MINbxx(N). F_Qx_b04() / F_Qx_b02()
+ *          decode like F_Qx_b08(). The _array forms quantize and pack, or
+ *          unpack and decode, whole arrays with the same results (AVX2:
+ *          pmaddubsw to pack, shifts and a pshufb sign extend to unpack).
+ *          q_b04_get() / q_b04_set() and the 2-bit ones access single
+ *          elements.
+ *
+ *          @code
+ *          fix4x2_t w[Q_B04_BYTES(1000)];
+ *          Q3_b4_array(w, weights, 1000);              // 500 bytes
+ *          float32_t w7 = F_Qx_b04_get(3, w, 7);       // one element
+ *          F_Q3b4_array(weights, w, 1000);
+ *          @endcode
+ *
+ * @note    With an odd count (4-bit) or a count not a multiple of 4 (2-bit)
+ *          the unused bits of the last byte are written as 0.
+ * @note    Packed conversions are not counted by q_sat.h.
+ */
+
+#ifndef SRC_Q_PACK_H_
+#define SRC_Q_PACK_H_
+
+
+#include "q_macros.h"
+#include "q_simd.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define Q_B04_BYTES(n)      ( ((n) + 1) / 2 )   /**< Bytes for n packed 4-bit words. */
+#define Q_B02_BYTES(n)      ( ((n) + 3) / 4 )   /**< Bytes for n packed 2-bit words. */
+
+#define Q_MAXb04            ( (fix8_t)7 )       /* Max 4 bit positive value in fixed-point domain. */
+#define Q_MINb04            ( (fix8_t)-8 )      /* Min 4 bit negative value in fixed-point domain. */
+#define Q_MAXb02            ( (fix8_t)1 )       /* Max 2 bit positive value in fixed-point domain. */
+#define Q_MINb02            ( (fix8_t)-2 )      /* Min 2 bit negative value in fixed-point domain. */
+
+#define F_MAXb04(N)         ( (float32_t)( 1U << (4-1-(N)) ) )      /* Max 4 bit positive value as float. */
+#define F_MAXb02(N)         ( (float32_t)( 1U << (2-1-(N)) ) )      /* Max 2 bit positive value as float. */
+#define F_MINb04(N)         ( -F_MAXb04(N) )                        /* Min 4 bit negative value as float. */
+#define F_MINb02(N)         ( -F_MAXb02(N) )                        /* Min 2 bit negative value as float. */
+
+/** @brief Converts from float32 to 4-bit fixed-point (in a fix8_t) with saturation. */
+#define Qx_b04(N,x)         ( (float32_t)(x)>=F_MAXb04(N) ? Q_MAXb04 : ( (float32_t)(x)<F_MINb04(N) ? Q_MINb04 : (fix8_t)( (float32_t)(x)*(float32_t)SCALE_FACTOR_08(N) ) ) )
+/** @brief Converts from float32 to 2-bit fixed-point (in a fix8_t) with saturation. */
+#define Qx_b02(N,x)         ( (float32_t)(x)>=F_MAXb02(N) ? Q_MAXb02 : ( (float32_t)(x)<F_MINb02(N) ? Q_MINb02 : (fix8_t)( (float32_t)(x)*(float32_t)SCALE_FACTOR_08(N) ) ) )
+/** @brief Converts back from 4-bit fixed-point to floating-point. */
+#define F_Qx_b04(N,x)       F_Qx_b08(N,x)
+/** @brief Converts back from 2-bit fixed-point to floating-point. */
+#define F_Qx_b02(N,x)       F_Qx_b08(N,x)
+
+
+// Single elements
+
+/** @brief Element i of a packed 4-bit array, sign extended. */
+static inline fix8_t q_b04_get(const fix4x2_t *p, size_t i)
+{
+    int v = (p[i >> 1] >> ((i & 1U) * 4U)) & 0xF;
+    return (fix8_t)((v ^ 8) - 8);
+}
+
+/** @brief Element i of a packed 2-bit array, sign extended. */
+static inline fix8_t q_b02_get(const fix2x4_t *p, size_t i)
+{
+    int v = (p[i >> 2] >> ((i & 3U) * 2U)) & 0x3;
+    return (fix8_t)((v ^ 2) - 2);
+}
+
+/** @brief Sets element i of a packed 4-bit array to the low 4 bits of v. */
+static inline void q_b04_set(fix4x2_t *p, size_t i, fix8_t v)
+{
+    unsigned int s = (unsigned int)(i & 1U) * 4U;
+    p[i >> 1] = (fix4x2_t)((p[i >> 1] & ~(0xFU << s)) | (((unsigned int)v & 0xFU) << s));
+}
+
+/** @brief Sets element i of a packed 2-bit array to the low 2 bits of v. */
+static inline void q_b02_set(fix2x4_t *p, size_t i, fix8_t v)
+{
+    unsigned int s = (unsigned int)(i & 3U) * 2U;
+    p[i >> 2] = (fix2x4_t)((p[i >> 2] & ~(0x3U << s)) | (((unsigned int)v & 0x3U) << s));
+}
+
+/** @brief Element i of a packed 4-bit Qn array as float. */
+#define F_Qx_b04_get(N, p, i)       F_Qx_b04(N, q_b04_get(p, i))
+/** @brief Element i of a packed 2-bit Qn array as float. */
+#define F_Qx_b02_get(N, p, i)       F_Qx_b02(N, q_b02_get(p, i))
+/** @brief Quantizes x to 4-bit Qn into element i of a packed array. */
+#define Qx_b04_set(N, p, i, x)      q_b04_set(p, i, Qx_b04(N, x))
+/** @brief Quantizes x to 2-bit Qn into element i of a packed array. */
+#define Qx_b02_set(N, p, i, x)      q_b02_set(p, i, Qx_b02(N, x))
+
+
+// Plain C kernels, reference for all others.
+
+static inline void q_f32_to_b04_c(unsigned int N, fix4x2_t *dst, const float32_t *src, size_t n)
+{
+    size_t i = 0;
+
+    for (; i + 2 <= n; i += 2)
+    {
+        dst[i >> 1] = (fix4x2_t)(((unsigned int)Qx_b04(N, src[i]) & 0xFU) | (((unsigned int)Qx_b04(N, src[i + 1]) & 0xFU) << 4));
+    }
+    if (i < n)
+    {
+        dst[i >> 1] = (fix4x2_t)((unsigned int)Qx_b04(N, src[i]) & 0xFU);
+    }
+}
+
+static inline void q_f32_to_b02_c(unsigned int N, fix2x4_t *dst, const float32_t *src, size_t n)
+{
+    for (size_t i = 0; i < n; i += 4)
+    {
+        unsigned int b = 0;
+        for (size_t j = 0; j < 4 && i + j < n; j++)
+        {
+            b |= ((unsigned int)Qx_b02(N, src[i + j]) & 0x3U) << (2 * j);
+        }
+        dst[i >> 2] = (fix2x4_t)b;
+    }
+}
+
+static inline void q_b04_to_f32_c(unsigned int N, float32_t *dst, const fix4x2_t *src, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        dst[i] = F_Qx_b04(N, q_b04_get(src, i));
+    }
+}
+
+static inline void q_b02_to_f32_c(unsigned int N, float32_t *dst, const fix2x4_t *src, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        dst[i] = F_Qx_b02(N, q_b02_get(src, i));
+    }
+}
+
+
+#if Q_SIMD_AVX2
+Q_TARGET_AVX2_BEGIN
+
+/*
+ * Quantize 32 floats to 32 int8 in order: clamp the scaled value to
+ * [Q_MINbxx, Q_MAXbxx], truncate, pack, and undo the per-lane pack order.
+ */
+static inline __m256i q_pack_q32_avx2(const float32_t *src, __m256 scale, __m256 hi, __m256 lo)
+{
+    __m256 a = _mm256_max_ps(_mm256_min_ps(_mm256_mul_ps(_mm256_loadu_ps(src     ), scale), hi), lo);
+    __m256 b = _mm256_max_ps(_mm256_min_ps(_mm256_mul_ps(_mm256_loadu_ps(src +  8), scale), hi), lo);
+    __m256 c = _mm256_max_ps(_mm256_min_ps(_mm256_mul_ps(_mm256_loadu_ps(src + 16), scale), hi), lo);
+    __m256 d = _mm256_max_ps(_mm256_min_ps(_mm256_mul_ps(_mm256_loadu_ps(src + 24), scale), hi), lo);
+    __m256i ab = _mm256_packs_epi32(_mm256_cvttps_epi32(a), _mm256_cvttps_epi32(b));
+    __m256i cd = _mm256_packs_epi32(_mm256_cvttps_epi32(c), _mm256_cvttps_epi32(d));
+    return _mm256_permutevar8x32_epi32(_mm256_packs_epi16(ab, cd), _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+}
+
+/* Sign-extended int8 words 0 .. 15 of e to floats times scale. */
+static inline void q_unpack_f32_avx2(float32_t *dst, __m128i e, __m256 scale)
+{
+    _mm256_storeu_ps(dst,     _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(e)), scale));
+    _mm256_storeu_ps(dst + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_mm_srli_si128(e, 8))), scale));
+}
+
+static inline void q_f32_to_b04_avx2(unsigned int N, fix4x2_t *dst, const float32_t *src, size_t n)
+{
+    const __m256  scale = _mm256_set1_ps((float32_t)SCALE_FACTOR_08(N));
+    const __m256  hi    = _mm256_set1_ps((float32_t)Q_MAXb04);
+    const __m256  lo    = _mm256_set1_ps((float32_t)Q_MINb04);
+    const __m256i m4    = _mm256_set1_epi8(0x0F);
+    const __m256i w     = _mm256_set1_epi16(0x1001);      /* Byte weights 1, 16. */
+    size_t i = 0;
+
+    for (; i + 32 <= n; i += 32)
+    {
+        __m256i b = _mm256_maddubs_epi16(_mm256_and_si256(q_pack_q32_avx2(src + i, scale, hi, lo), m4), w);
+        _mm_storeu_si128((__m128i *)(dst + (i >> 1)),
+                         _mm_packus_epi16(_mm256_castsi256_si128(b), _mm256_extracti128_si256(b, 1)));
+    }
+    q_f32_to_b04_c(N, dst + (i >> 1), src + i, n - i);
+}
+
+static inline void q_f32_to_b02_avx2(unsigned int N, fix2x4_t *dst, const float32_t *src, size_t n)
+{
+    const __m256  scale = _mm256_set1_ps((float32_t)SCALE_FACTOR_08(N));
+    const __m256  hi    = _mm256_set1_ps((float32_t)Q_MAXb02);
+    const __m256  lo    = _mm256_set1_ps((float32_t)Q_MINb02);
+    const __m256i m2    = _mm256_set1_epi8(0x03);
+    const __m256i w1    = _mm256_set1_epi16(0x0401);      /* Byte weights 1, 4. */
+    const __m256i w2    = _mm256_set1_epi32(0x00100001);  /* Pair weights 1, 16. */
+    size_t i = 0;
+
+    for (; i + 32 <= n; i += 32)
+    {
+        __m256i b = _mm256_madd_epi16(_mm256_maddubs_epi16(_mm256_and_si256(q_pack_q32_avx2(src + i, scale, hi, lo), m2), w1), w2);
+        __m128i p = _mm_packus_epi32(_mm256_castsi256_si128(b), _mm256_extracti128_si256(b, 1));
+        _mm_storel_epi64((__m128i *)(dst + (i >> 2)), _mm_packus_epi16(p, p));
+    }
+    q_f32_to_b02_c(N, dst + (i >> 2), src + i, n - i);
+}
+
+static inline void q_b04_to_f32_avx2(unsigned int N, float32_t *dst, const fix4x2_t *src, size_t n)
+{
+    const __m256  scale = _mm256_set1_ps(1.0f / (float32_t)SCALE_FACTOR_08(N));
+    const __m128i m4    = _mm_set1_epi8(0x0F);
+    const __m128i sx    = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, -8, -7, -6, -5, -4, -3, -2, -1);
+    size_t i = 0;
+
+    for (; i + 32 <= n; i += 32)
+    {
+        __m128i b  = _mm_loadu_si128((const __m128i *)(src + (i >> 1)));
+        __m128i lw = _mm_shuffle_epi8(sx, _mm_and_si128(b, m4));
+        __m128i hw = _mm_shuffle_epi8(sx, _mm_and_si128(_mm_srli_epi16(b, 4), m4));
+        q_unpack_f32_avx2(dst + i,      _mm_unpacklo_epi8(lw, hw), scale);
+        q_unpack_f32_avx2(dst + i + 16, _mm_unpackhi_epi8(lw, hw), scale);
+    }
+    q_b04_to_f32_c(N, dst + i, src + (i >> 1), n - i);
+}
+
+static inline void q_b02_to_f32_avx2(unsigned int N, float32_t *dst, const fix2x4_t *src, size_t n)
+{
+    const __m256  scale = _mm256_set1_ps(1.0f / (float32_t)SCALE_FACTOR_08(N));
+    const __m128i m2    = _mm_set1_epi8(0x03);
+    const __m128i sx    = _mm_setr_epi8(0, 1, -2, -1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    size_t i = 0;
+
+    for (; i + 32 <= n; i += 32)
+    {
+        __m128i b  = _mm_loadl_epi64((const __m128i *)(src + (i >> 2)));
+        __m128i f0 = _mm_shuffle_epi8(sx, _mm_and_si128(b, m2));
+        __m128i f1 = _mm_shuffle_epi8(sx, _mm_and_si128(_mm_srli_epi16(b, 2), m2));
+        __m128i f2 = _mm_shuffle_epi8(sx, _mm_and_si128(_mm_srli_epi16(b, 4), m2));
+        __m128i f3 = _mm_shuffle_epi8(sx, _mm_and_si128(_mm_srli_epi16(b, 6), m2));
+        __m128i a  = _mm_unpacklo_epi8(f0, f1);
+        __m128i c  = _mm_unpacklo_epi8(f2, f3);
+        q_unpack_f32_avx2(dst + i,      _mm_unpacklo_epi16(a, c), scale);
+        q_unpack_f32_avx2(dst + i + 16, _mm_unpackhi_epi16(a, c), scale);
+    }
+    q_b02_to_f32_c(N, dst + i, src + (i >> 2), n - i);
+}
+
+Q_TARGET_END
+#endif /* Q_SIMD_AVX2 */
+
+
+// Kernel table, bound once per translation unit to the tier from q_isa().
+
+typedef struct
+{
+    void (*f32_to_b04)(unsigned int N, fix4x2_t *dst, const float32_t *src, size_t n);
+    void (*f32_to_b02)(unsigned int N, fix2x4_t *dst, const float32_t *src, size_t n);
+    void (*b04_to_f32)(unsigned int N, float32_t *dst, const fix4x2_t *src, size_t n);
+    void (*b02_to_f32)(unsigned int N, float32_t *dst, const fix2x4_t *src, size_t n);
+    int    bound;
+} q_pack_fn_t;
+
+static q_pack_fn_t q_pack_k;
+
+/** @brief Fills q_pack_k for q_isa(). Runs before main() where supported. @note RARELY USE DIRECTLY. */
+static Q_CONSTRUCTOR void q_pack_bind(void)
+{
+    q_isa_t     isa = q_isa();
+    q_pack_fn_t k   = { q_f32_to_b04_c, q_f32_to_b02_c, q_b04_to_f32_c, q_b02_to_f32_c, 1 };
+
+    (void)isa;
+#if Q_SIMD_AVX2
+    if (isa >= Q_ISA_AVX2)
+    {
+        k.f32_to_b04 = q_f32_to_b04_avx2;
+        k.f32_to_b02 = q_f32_to_b02_avx2;
+        k.b04_to_f32 = q_b04_to_f32_avx2;
+        k.b02_to_f32 = q_b02_to_f32_avx2;
+    }
+#endif
+    q_pack_k = k;
+}
+
+/** @brief Bound kernel table. Binds on first use if the constructor has not run yet. @note RARELY USE DIRECTLY. */
+static inline const q_pack_fn_t *q_pack_fn(void)
+{
+    if (!q_pack_k.bound)
+    {
+        q_pack_bind();
+    }
+    return &q_pack_k;
+}
+
+
+// Use this!
+
+/** @brief Converts n floats to packed 4-bit Qn (N 0 .. 3), dst has Q_B04_BYTES(n) bytes. */
+static inline void Qx_b04_array(unsigned int N, fix4x2_t *dst, const float32_t *src, size_t n)
+{
+    q_pack_fn()->f32_to_b04(N, dst, src, n);
+}
+
+/** @brief Converts n floats to packed 2-bit Qn (N 0 .. 1), dst has Q_B02_BYTES(n) bytes. */
+static inline void Qx_b02_array(unsigned int N, fix2x4_t *dst, const float32_t *src, size_t n)
+{
+    q_pack_fn()->f32_to_b02(N, dst, src, n);
+}
+
+/** @brief Converts n packed 4-bit Qn words to float. */
+static inline void F_Qx_b04_array(unsigned int N, float32_t *dst, const fix4x2_t *src, size_t n)
+{
+    q_pack_fn()->b04_to_f32(N, dst, src, n);
+}
+
+/** @brief Converts n packed 2-bit Qn words to float. */
+static inline void F_Qx_b02_array(unsigned int N, float32_t *dst, const fix2x4_t *src, size_t n)
+{
+    q_pack_fn()->b02_to_f32(N, dst, src, n);
+}
+
+// Most used formats.
+#define Q3_b4_array(dst, src, n)    Qx_b04_array(3, dst, src, n)    /**< Converts float array to packed 4-bit Q3. */
+#define Q1_b2_array(dst, src, n)    Qx_b02_array(1, dst, src, n)    /**< Converts float array to packed 2-bit Q1. */
+#define F_Q3b4_array(dst, src, n)   F_Qx_b04_array(3, dst, src, n)  /**< Converts packed 4-bit Q3 array to float. */
+#define F_Q1b2_array(dst, src, n)   F_Qx_b02_array(1, dst, src, n)  /**< Converts packed 2-bit Q1 array to float. */
+
+
+#endif /* SRC_Q_PACK_H_ */
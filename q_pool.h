@@ -0,0 +1,379 @@
+/**
+ * @file    q_pool.h
+ * @brief   Multithreaded array conversion on a persistent worker pool.
+ *
+ *          q_pool_create() starts the workers once; Qx_bxx_array_mt(),
+ *          F_Qx_bxx_array_mt() and Qx_bxx_array_r_mt() then split the array
+ *          into chunks and run the normal single-thread kernels on them, so
+ *          results are bit-identical to Qx_bxx_array() and friends.
+ *
+ *          Chunks are Q_POOL_CHUNK elements with boundaries on 64-byte lines
+ *          of dst, so no two threads write the same cache line. Each worker
+ *          owns a contiguous run of chunks and takes them in order with an
+ *          atomic counter; when its run is done it steals from the others'.
+ *
+ *          Below Q_POOL_MIN_N elements, or with pool NULL, everything runs on
+ *          the calling thread with no locking or wake-ups.
+ *
+ *          On NUMA machines, q_pool_touch() on a freshly allocated output
+ *          buffer makes each page first-touched (and so placed) by the worker
+ *          that owns its chunks in later conversions of the same size.
+ *
+ *          @code
+ *          q_pool_t *pool = q_pool_create(0);      // one thread per CPU
+ *          q_pool_touch(pool, out, n, sizeof(fix16_t));
+ *          Q15_b16_array_mt(pool, out, in, n);
+ *          q_pool_destroy(pool);
+ *          @endcode
+ *
+ * @note    POSIX threads, link with -pthread.
+ * @note    One job at a time per pool: concurrent calls are serialized,
+ *          calling a pool from inside its own job deadlocks.
+ */
+
+#ifndef SRC_Q_POOL_H_
+#define SRC_Q_POOL_H_
+
+
+#include "q_round.h"
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#ifndef Q_POOL_MIN_N
+#define Q_POOL_MIN_N    (1U << 18)  /**< Smaller arrays run on the calling thread. */
+#endif
+
+#ifndef Q_POOL_CHUNK
+#define Q_POOL_CHUNK    (1U << 14)  /**< Elements per chunk, multiple of 64. */
+#endif
+
+#define Q_POOL_LINE     64U         /**< Cache line bytes. */
+#define Q_POOL_PAGE     4096U       /**< Page bytes for q_pool_touch(). */
+
+/** @brief Converts elements [begin, end) of a job. */
+typedef void (*q_pool_fn_t)(void *ctx, size_t begin, size_t end);
+
+/** @brief Chunk counter of one worker, one cache line each. */
+typedef struct
+{
+    size_t next;                                        /**< Next chunk to take. */
+    size_t end;                                         /**< One past the worker's last chunk. */
+    char   pad[Q_POOL_LINE - 2 * sizeof(size_t)];
+} q_pool_slot_t;
+
+typedef struct q_pool q_pool_t;
+
+/** @brief Start argument of a worker thread. */
+typedef struct
+{
+    q_pool_t     *pool;
+    unsigned int  w;
+} q_pool_arg_t;
+
+/**
+ * @brief Worker pool. The calling thread is worker 0, nthreads - 1 threads are started.
+ */
+struct q_pool
+{
+    unsigned int    nthreads;
+    pthread_t      *threads;
+    q_pool_arg_t   *args;
+    q_pool_slot_t  *slot;       /**< nthreads slots, line aligned inside slot_mem. */
+    void           *slot_mem;
+
+    pthread_mutex_t run;        /**< Held for a whole job. */
+    pthread_mutex_t lock;       /**< Guards everything below. */
+    pthread_cond_t  wake;
+    pthread_cond_t  done;
+    unsigned long   gen;        /**< Bumped for each job. */
+    unsigned int    busy;       /**< Started threads still on the job. */
+    int             quit;
+
+    q_pool_fn_t     fn;
+    void           *ctx;
+    size_t          n;
+    size_t          skew;       /**< Elements before the first line-aligned chunk boundary. */
+};
+
+
+/** @brief Element range of chunk c. @note RARELY USE DIRECTLY. */
+static inline void q_pool_chunk(const q_pool_t *p, size_t c, size_t *begin, size_t *end)
+{
+    size_t e = p->skew + (c + 1) * Q_POOL_CHUNK;
+    *begin = c == 0 ? 0 : p->skew + c * Q_POOL_CHUNK;
+    *end   = e < p->n ? e : p->n;
+}
+
+/** @brief Runs the chunks of worker w, then steals from the others. @note RARELY USE DIRECTLY. */
+static inline void q_pool_work(q_pool_t *p, unsigned int w)
+{
+    for (unsigned int k = 0; k < p->nthreads; k++)
+    {
+        q_pool_slot_t *s = &p->slot[(w + k) % p->nthreads];
+
+        for (;;)
+        {
+            size_t c = __atomic_fetch_add(&s->next, 1, __ATOMIC_RELAXED);
+            size_t b, e;
+            if (c >= s->end)
+            {
+                break;
+            }
+            q_pool_chunk(p, c, &b, &e);
+            p->fn(p->ctx, b, e);
+        }
+    }
+}
+
+/** @brief Worker thread: wait for a job, run it, report. @note RARELY USE DIRECTLY. */
+static inline void *q_pool_main(void *arg)
+{
+    q_pool_t     *p   = ((q_pool_arg_t *)arg)->pool;
+    unsigned int  w   = ((q_pool_arg_t *)arg)->w;
+    unsigned long gen = 0;
+
+    pthread_mutex_lock(&p->lock);
+    for (;;)
+    {
+        while (p->gen == gen && !p->quit)
+        {
+            pthread_cond_wait(&p->wake, &p->lock);
+        }
+        if (p->quit)
+        {
+            break;
+        }
+        gen = p->gen;
+        pthread_mutex_unlock(&p->lock);
+
+        q_pool_work(p, w);
+
+        pthread_mutex_lock(&p->lock);
+        if (--p->busy == 0)
+        {
+            pthread_cond_signal(&p->done);
+        }
+    }
+    pthread_mutex_unlock(&p->lock);
+    return NULL;
+}
+
+/**
+ * @brief Stops and frees a pool from q_pool_create(). NULL is ignored.
+ */
+static inline void q_pool_destroy(q_pool_t *p)
+{
+    if (p == NULL)
+    {
+        return;
+    }
+    pthread_mutex_lock(&p->lock);
+    p->quit = 1;
+    pthread_cond_broadcast(&p->wake);
+    pthread_mutex_unlock(&p->lock);
+    for (unsigned int w = 1; w < p->nthreads; w++)
+    {
+        pthread_join(p->threads[w], NULL);
+    }
+    pthread_cond_destroy(&p->done);
+    pthread_cond_destroy(&p->wake);
+    pthread_mutex_destroy(&p->lock);
+    pthread_mutex_destroy(&p->run);
+    free(p->slot_mem);
+    free(p->args);
+    free(p->threads);
+    free(p);
+}
+
+/**
+ * @brief Starts a pool of nthreads threads including the caller, 0 for one per online CPU.
+ * @return NULL when out of memory or threads cannot be started.
+ */
+static inline q_pool_t *q_pool_create(unsigned int nthreads)
+{
+    q_pool_t *p = (q_pool_t *)calloc(1, sizeof(q_pool_t));
+
+    if (nthreads == 0)
+    {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        nthreads  = cpus > 0 ? (unsigned int)cpus : 1U;
+    }
+    if (p == NULL)
+    {
+        return NULL;
+    }
+    p->threads  = (pthread_t *)calloc(nthreads, sizeof(pthread_t));
+    p->args     = (q_pool_arg_t *)calloc(nthreads, sizeof(q_pool_arg_t));
+    p->slot_mem = calloc(nthreads + 1, sizeof(q_pool_slot_t));
+    if (p->threads == NULL || p->args == NULL || p->slot_mem == NULL)
+    {
+        free(p->slot_mem);
+        free(p->args);
+        free(p->threads);
+        free(p);
+        return NULL;
+    }
+    p->slot = (q_pool_slot_t *)(((uintptr_t)p->slot_mem + Q_POOL_LINE - 1) & ~(uintptr_t)(Q_POOL_LINE - 1));
+
+    pthread_mutex_init(&p->run, NULL);
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_cond_init(&p->wake, NULL);
+    pthread_cond_init(&p->done, NULL);
+
+    p->nthreads = 1;
+    for (unsigned int w = 1; w < nthreads; w++)
+    {
+        p->args[w].pool = p;
+        p->args[w].w    = w;
+        if (pthread_create(&p->threads[w], NULL, q_pool_main, &p->args[w]) != 0)
+        {
+            q_pool_destroy(p);
+            return NULL;
+        }
+        p->nthreads = w + 1;
+    }
+    return p;
+}
+
+/** @brief Number of threads including the caller, 1 for NULL. */
+static inline unsigned int q_pool_threads(const q_pool_t *p)
+{
+    return p == NULL ? 1U : p->nthreads;
+}
+
+/**
+ * @brief Runs fn over [0, n) in chunks on all threads and returns when done.
+ *        dst and elem_size place the chunk boundaries on cache lines of the output.
+ */
+static inline void q_pool_for(q_pool_t *p, q_pool_fn_t fn, void *ctx, size_t n, const void *dst, size_t elem_size)
+{
+    if (p == NULL || p->nthreads < 2 || n < Q_POOL_MIN_N)
+    {
+        fn(ctx, 0, n);
+        return;
+    }
+
+    size_t skew    = (size_t)((Q_POOL_LINE - (uintptr_t)dst % Q_POOL_LINE) % Q_POOL_LINE) / elem_size;
+    size_t nchunks = (n - skew + Q_POOL_CHUNK - 1) / Q_POOL_CHUNK;
+
+    pthread_mutex_lock(&p->run);
+    pthread_mutex_lock(&p->lock);
+    p->fn   = fn;
+    p->ctx  = ctx;
+    p->n    = n;
+    p->skew = skew;
+    for (unsigned int w = 0; w < p->nthreads; w++)
+    {
+        p->slot[w].next = nchunks *  w      / p->nthreads;
+        p->slot[w].end  = nchunks * (w + 1) / p->nthreads;
+    }
+    p->busy = p->nthreads - 1;
+    p->gen++;
+    pthread_cond_broadcast(&p->wake);
+    pthread_mutex_unlock(&p->lock);
+
+    q_pool_work(p, 0);
+
+    pthread_mutex_lock(&p->lock);
+    while (p->busy != 0)
+    {
+        pthread_cond_wait(&p->done, &p->lock);
+    }
+    pthread_mutex_unlock(&p->lock);
+    pthread_mutex_unlock(&p->run);
+}
+
+
+/** @brief Arguments of a conversion job. @note RARELY USE DIRECTLY. */
+typedef struct
+{
+    unsigned int  N;
+    void         *dst;
+    const void   *src;
+    size_t        elem_size;
+    q_round_t     mode;
+    uint32_t      ctr;
+} q_pool_job_t;
+
+/** @brief Writes one byte per page of each chunk. @note RARELY USE DIRECTLY. */
+static inline void q_pool_touch_chunk(void *ctx, size_t begin, size_t end)
+{
+    const q_pool_job_t *j = (const q_pool_job_t *)ctx;
+    char               *d = (char *)j->dst;
+
+    for (size_t o = begin * j->elem_size; o < end * j->elem_size; o = (o / Q_POOL_PAGE + 1) * Q_POOL_PAGE)
+    {
+        d[o] = 0;
+    }
+}
+
+/**
+ * @brief Touches every page of an n-element output buffer from the worker that converts it.
+ *        Call once on fresh memory; contents of dst are clobbered.
+ */
+static inline void q_pool_touch(q_pool_t *p, void *dst, size_t n, size_t elem_size)
+{
+    q_pool_job_t j = { 0U, dst, NULL, elem_size, Q_ROUND_TRUNC, 0U };
+    q_pool_for(p, q_pool_touch_chunk, &j, n, dst, elem_size);
+}
+
+
+#define Q_POOL_ARRAY(W, T)                                                                  \
+    static inline void q_pool_f32_to_b##W(void *ctx, size_t b, size_t e)                    \
+    {                                                                                       \
+        const q_pool_job_t *j = (const q_pool_job_t *)ctx;                                  \
+        Qx_b##W##_array(j->N, (T *)j->dst + b, (const float32_t *)j->src + b, e - b);       \
+    }                                                                                       \
+    static inline void q_pool_b##W##_to_f32(void *ctx, size_t b, size_t e)                  \
+    {                                                                                       \
+        const q_pool_job_t *j = (const q_pool_job_t *)ctx;                                  \
+        F_Qx_b##W##_array(j->N, (float32_t *)j->dst + b, (const T *)j->src + b, e - b);     \
+    }                                                                                       \
+    static inline void q_pool_f32_to_b##W##_r(void *ctx, size_t b, size_t e)                \
+    {                                                                                       \
+        const q_pool_job_t *j = (const q_pool_job_t *)ctx;                                  \
+        Qx_b##W##_array_r(j->N, (T *)j->dst + b, (const float32_t *)j->src + b, e - b,      \
+                          j->mode, j->ctr + (uint32_t)b);                                   \
+    }                                                                                       \
+    /** @brief Qx_bxx_array() on the pool. */                                              \
+    static inline void Qx_b##W##_array_mt(q_pool_t *pool, unsigned int N,                   \
+                                          T *dst, const float32_t *src, size_t n)           \
+    {                                                                                       \
+        q_pool_job_t j = { N, dst, src, sizeof(T), Q_ROUND_TRUNC, 0U };                     \
+        q_pool_for(pool, q_pool_f32_to_b##W, &j, n, dst, sizeof(T));                        \
+    }                                                                                       \
+    /** @brief F_Qx_bxx_array() on the pool. */                                            \
+    static inline void F_Qx_b##W##_array_mt(q_pool_t *pool, unsigned int N,                 \
+                                            float32_t *dst, const T *src, size_t n)         \
+    {                                                                                       \
+        q_pool_job_t j = { N, dst, src, sizeof(float32_t), Q_ROUND_TRUNC, 0U };             \
+        q_pool_for(pool, q_pool_b##W##_to_f32, &j, n, dst, sizeof(float32_t));              \
+    }                                                                                       \
+    /** @brief Qx_bxx_array_r() on the pool, element i uses ctr + i as in the serial call. */ \
+    static inline void Qx_b##W##_array_r_mt(q_pool_t *pool, unsigned int N, T *dst,         \
+                                            const float32_t *src, size_t n,                 \
+                                            q_round_t mode, uint32_t ctr)                   \
+    {                                                                                       \
+        q_pool_job_t j = { N, dst, src, sizeof(T), mode, ctr };                             \
+        q_pool_for(pool, q_pool_f32_to_b##W##_r, &j, n, dst, sizeof(T));                    \
+    }
+
+
+// Use this!
+
+Q_POOL_ARRAY(08, fix8_t)
+Q_POOL_ARRAY(16, fix16_t)
+Q_POOL_ARRAY(32, fix32_t)
+Q_POOL_ARRAY(64, fix64_t)
+
+// Most used formats.
+#define Q15_b16_array_mt(pool, dst, src, n)     Qx_b16_array_mt(pool, 15, dst, src, n)   /**< Converts float array to 16-bit Q15 on the pool. */
+#define Q31_b32_array_mt(pool, dst, src, n)     Qx_b32_array_mt(pool, 31, dst, src, n)   /**< Converts float array to 32-bit Q31 on the pool. */
+#define F_Q15b16_array_mt(pool, dst, src, n)    F_Qx_b16_array_mt(pool, 15, dst, src, n) /**< Converts 16-bit Q15 array to float on the pool. */
+#define F_Q31b32_array_mt(pool, dst, src, n)    F_Qx_b32_array_mt(pool, 31, dst, src, n) /**< Converts 32-bit Q31 array to float on the pool. */
+
+
+#endif /* SRC_Q_POOL_H_ */
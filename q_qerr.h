@@ -0,0 +1,400 @@
+/**
+ * @file    q_qerr.h
+ * @brief   Quantization error of a float buffer for every Q format of one
+ *          word size, in one pass, with a recommended N.
+ *
+ *          q_qerr() reads the buffer once, a block of Q_QERR_BLOCK samples at
+ *          a time, and while the block is in L1 runs every candidate N in
+ *          0 .. W-1 (W = 8, 16 or 32) over it. Per N it reports:
+ *          - sat: inputs at or above F_MAXbxx(N) or below F_MINbxx(N),
+ *          - max_err: largest |x - F_Qx_bxx(N, Qx_bxx(N, x))| (float32 math,
+ *            the round trip the array functions do),
+ *          - err2 and snr_db: sum of squared errors and
+ *            10 log10(sum x^2 / err2), +inf for an exact format.
+ *
+ *          best is the N with the highest SNR, ties going to fewer
+ *          saturations, then to the larger N. q_qerr_mt() splits the buffer
+ *          over a q_pool.h pool.
+ *
+ *          @code
+ *          q_qerr_t r;
+ *          q_qerr(16, calib, n, &r);
+ *          Qx_b16_array(r.best, out, in, m);           // Q<best> for this signal
+ *          q_qerr_fprint(stderr, &r);                  // table of all N
+ *          @endcode
+ *
+ * @note    sat and max_err are exact and the same on every tier and thread
+ *          count. Every tier squares in double; the sums (sig2, err2, so
+ *          snr_db) are only added in a different order by the SIMD kernels
+ *          and the pool, so they can differ in the last bits.
+ * @note    Uses log10(), link with -lm. NaN input is undefined, same as with
+ *          the scalar macros.
+ */
+
+#ifndef SRC_Q_QERR_H_
+#define SRC_Q_QERR_H_
+
+
+#include "q_macros.h"
+#include "q_pool.h"
+#include "q_simd.h"
+#include <math.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifndef Q_QERR_BLOCK
+#define Q_QERR_BLOCK    256U        /**< Samples per block, run through all N while in L1. Multiple of 16. */
+#endif
+
+/** @brief Error of one Q format. */
+typedef struct
+{
+    uint64_t  sat;      /**< Inputs clipped to Q_MAXbxx or Q_MINbxx. */
+    float64_t max_err;  /**< Largest absolute round-trip error. */
+    float64_t err2;     /**< Sum of squared round-trip errors. */
+    float64_t snr_db;   /**< 10 log10(sig2 / err2), +inf if err2 is 0. */
+} q_qerr_n_t;
+
+/** @brief Error report of a buffer for every N of one word size. */
+typedef struct
+{
+    unsigned int W;     /**< Word size, 8, 16 or 32. */
+    unsigned int best;  /**< Recommended N. */
+    uint64_t     n;     /**< Samples analysed. */
+    float64_t    sig2;  /**< Sum of squared inputs. */
+    q_qerr_n_t   q[32]; /**< Per N, 0 .. W-1. */
+} q_qerr_t;
+
+/** @brief Scaled value the truncation is clamped to, as float: Q_MAXbxx rounds to 2^(W-1) for W = 32. @note RARELY USE DIRECTLY. */
+#define Q_QERR_QHI(W)   ( (float32_t)( (1ULL << ((W) - 1)) - 1U ) )
+
+
+// Plain C kernels, reference for all others.
+
+static inline void q_qerr_c(unsigned int W, const float32_t *src, size_t n, q_qerr_t *r)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        float32_t x = src[i];
+
+        r->sig2 += (float64_t)x * x;
+        for (unsigned int N = 0; N < W; N++)
+        {
+            float32_t y, e;
+            int       sat;
+
+            switch (W)
+            {
+            case 8:
+                y   = F_Qx_b08(N, Qx_b08(N, x));
+                sat = x >= F_MAXb08(N) || x < F_MINb08(N);
+                break;
+            case 16:
+                y   = F_Qx_b16(N, Qx_b16(N, x));
+                sat = x >= F_MAXb16(N) || x < F_MINb16(N);
+                break;
+            default:
+                y   = F_Qx_b32(N, Qx_b32(N, x));
+                sat = x >= F_MAXb32(N) || x < F_MINb32(N);
+                break;
+            }
+            e = fabsf(x - y);
+            r->q[N].sat     += (uint64_t)sat;
+            r->q[N].max_err  = e > r->q[N].max_err ? e : r->q[N].max_err;
+            r->q[N].err2    += (float64_t)e * e;
+        }
+    }
+}
+
+
+/*
+ * Per N: clamp x * 2^N to [Q_MINbxx, Q_MAXbxx] (Q_MAXb32 as the float it
+ * rounds to), truncate in float, scale back. That is the value
+ * F_Qx_bxx(N, Qx_bxx(N, x)) gives, without leaving the float domain. Squares
+ * are taken and summed in double, as in the C kernel, so huge or tiny inputs
+ * neither overflow nor flush to zero.
+ */
+
+#if Q_SIMD_AVX2
+Q_TARGET_AVX2_BEGIN
+
+/** @brief acc + v*v per lane, v widened to double first. @note RARELY USE DIRECTLY. */
+static inline __m256d q_qerr_sq_avx2(__m256d acc, __m256 v)
+{
+    __m256d lo = _mm256_cvtps_pd(_mm256_castps256_ps128(v));
+    __m256d hi = _mm256_cvtps_pd(_mm256_extractf128_ps(v, 1));
+    return _mm256_add_pd(acc, _mm256_add_pd(_mm256_mul_pd(lo, lo), _mm256_mul_pd(hi, hi)));
+}
+
+static inline float64_t q_qerr_sum_avx2(__m256d v)
+{
+    __m128d d = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(d, _mm_unpackhi_pd(d, d)));
+}
+
+static inline void q_qerr_avx2(unsigned int W, const float32_t *src, size_t n, q_qerr_t *r)
+{
+    const __m256 abs = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    const __m256 qhi = _mm256_set1_ps(Q_QERR_QHI(W));
+    const __m256 lim = _mm256_set1_ps((float32_t)(1ULL << (W - 1)));
+    const __m256 nlm = _mm256_set1_ps(-(float32_t)(1ULL << (W - 1)));
+    size_t i = 0;
+
+    while (i + 8 <= n)
+    {
+        size_t m  = n - i < Q_QERR_BLOCK ? (n - i) & ~(size_t)7 : Q_QERR_BLOCK;
+        __m256d x2 = _mm256_setzero_pd();
+
+        for (size_t j = i; j < i + m; j += 8)
+        {
+            x2 = q_qerr_sq_avx2(x2, _mm256_loadu_ps(src + j));
+        }
+        r->sig2 += q_qerr_sum_avx2(x2);
+
+        for (unsigned int N = 0; N < W; N++)
+        {
+            const __m256 s  = _mm256_set1_ps((float32_t)SCALE_FACTOR_64(N));
+            const __m256 rs = _mm256_set1_ps(1.0f / (float32_t)SCALE_FACTOR_64(N));
+            __m256d e2  = _mm256_setzero_pd();
+            __m256  mx  = _mm256_setzero_ps();
+            __m256i sat = _mm256_setzero_si256();
+            float32_t mr[8];
+            int32_t   sr[8];
+
+            for (size_t j = i; j < i + m; j += 8)
+            {
+                __m256 x = _mm256_loadu_ps(src + j);
+                __m256 y = _mm256_mul_ps(x, s);
+                __m256 c = _mm256_or_ps(_mm256_cmp_ps(y, lim, _CMP_GE_OQ), _mm256_cmp_ps(y, nlm, _CMP_LT_OQ));
+                __m256 q = _mm256_round_ps(_mm256_max_ps(_mm256_min_ps(y, qhi), nlm), _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+                __m256 e = _mm256_and_ps(_mm256_sub_ps(x, _mm256_mul_ps(q, rs)), abs);
+                sat = _mm256_sub_epi32(sat, _mm256_castps_si256(c));
+                mx  = _mm256_max_ps(mx, e);
+                e2  = q_qerr_sq_avx2(e2, e);
+            }
+            _mm256_storeu_ps(mr, mx);
+            _mm256_storeu_si256((__m256i *)sr, sat);
+            for (int k = 0; k < 8; k++)
+            {
+                r->q[N].sat    += (uint64_t)sr[k];
+                r->q[N].max_err = mr[k] > r->q[N].max_err ? mr[k] : r->q[N].max_err;
+            }
+            r->q[N].err2 += q_qerr_sum_avx2(e2);
+        }
+        i += m;
+    }
+    q_qerr_c(W, src + i, n - i, r);
+}
+
+Q_TARGET_END
+#endif /* Q_SIMD_AVX2 */
+
+
+#if Q_SIMD_AVX512
+Q_TARGET_AVX512_BEGIN
+
+/** @brief acc + v*v per lane, v widened to double first. @note RARELY USE DIRECTLY. */
+static inline __m512d q_qerr_sq_avx512(__m512d acc, __m512 v)
+{
+    __m512d lo = _mm512_cvtps_pd(_mm512_castps512_ps256(v));
+    __m512d hi = _mm512_cvtps_pd(_mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(v), 1)));
+    return _mm512_add_pd(acc, _mm512_add_pd(_mm512_mul_pd(lo, lo), _mm512_mul_pd(hi, hi)));
+}
+
+static inline void q_qerr_avx512(unsigned int W, const float32_t *src, size_t n, q_qerr_t *r)
+{
+    const __m512 qhi = _mm512_set1_ps(Q_QERR_QHI(W));
+    const __m512 lim = _mm512_set1_ps((float32_t)(1ULL << (W - 1)));
+    const __m512 nlm = _mm512_set1_ps(-(float32_t)(1ULL << (W - 1)));
+    size_t i = 0;
+
+    while (i + 16 <= n)
+    {
+        size_t m  = n - i < Q_QERR_BLOCK ? (n - i) & ~(size_t)15 : Q_QERR_BLOCK;
+        __m512d x2 = _mm512_setzero_pd();
+
+        for (size_t j = i; j < i + m; j += 16)
+        {
+            x2 = q_qerr_sq_avx512(x2, _mm512_loadu_ps(src + j));
+        }
+        r->sig2 += _mm512_reduce_add_pd(x2);
+
+        for (unsigned int N = 0; N < W; N++)
+        {
+            const __m512 s  = _mm512_set1_ps((float32_t)SCALE_FACTOR_64(N));
+            const __m512 rs = _mm512_set1_ps(1.0f / (float32_t)SCALE_FACTOR_64(N));
+            __m512d  e2  = _mm512_setzero_pd();
+            __m512   mx  = _mm512_setzero_ps();
+            uint64_t sat = 0;
+            float32_t me;
+
+            for (size_t j = i; j < i + m; j += 16)
+            {
+                __m512    x = _mm512_loadu_ps(src + j);
+                __m512    y = _mm512_mul_ps(x, s);
+                __mmask16 c = _mm512_cmp_ps_mask(y, lim, _CMP_GE_OQ) | _mm512_cmp_ps_mask(y, nlm, _CMP_LT_OQ);
+                __m512    q = _mm512_roundscale_ps(_mm512_max_ps(_mm512_min_ps(y, qhi), nlm), _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+                __m512    e = _mm512_abs_ps(_mm512_sub_ps(x, _mm512_mul_ps(q, rs)));
+                sat += (uint64_t)_mm_popcnt_u32(c);
+                mx   = _mm512_max_ps(mx, e);
+                e2   = q_qerr_sq_avx512(e2, e);
+            }
+            me = _mm512_reduce_max_ps(mx);
+            r->q[N].sat    += sat;
+            r->q[N].max_err = me > r->q[N].max_err ? me : r->q[N].max_err;
+            r->q[N].err2   += _mm512_reduce_add_pd(e2);
+        }
+        i += m;
+    }
+    q_qerr_c(W, src + i, n - i, r);
+}
+
+Q_TARGET_END
+#endif /* Q_SIMD_AVX512 */
+
+
+// Kernel table, bound once per translation unit to the tier from q_isa().
+
+typedef struct
+{
+    void (*f32)(unsigned int W, const float32_t *src, size_t n, q_qerr_t *r);
+    int    bound;
+} q_qerr_fn_t;
+
+static q_qerr_fn_t q_qerr_k;
+
+/** @brief Fills q_qerr_k for q_isa(). Runs before main() where supported. @note RARELY USE DIRECTLY. */
+static Q_CONSTRUCTOR void q_qerr_bind(void)
+{
+    q_isa_t     isa = q_isa();
+    q_qerr_fn_t k   = { q_qerr_c, 1 };
+
+    (void)isa;
+#if Q_SIMD_AVX2
+    if (isa >= Q_ISA_AVX2)
+    {
+        k.f32 = q_qerr_avx2;
+    }
+#endif
+#if Q_SIMD_AVX512
+    if (isa >= Q_ISA_AVX512)
+    {
+        k.f32 = q_qerr_avx512;
+    }
+#endif
+    q_qerr_k = k;
+}
+
+/** @brief Bound kernel table. Binds on first use if the constructor has not run yet. @note RARELY USE DIRECTLY. */
+static inline const q_qerr_fn_t *q_qerr_fn(void)
+{
+    if (!q_qerr_k.bound)
+    {
+        q_qerr_bind();
+    }
+    return &q_qerr_k;
+}
+
+
+/** @brief Empty report for word size W. @note RARELY USE DIRECTLY. */
+static inline void q_qerr_init(q_qerr_t *r, unsigned int W)
+{
+    memset(r, 0, sizeof(*r));
+    r->W = W;
+}
+
+/** @brief Adds the sums and counts of b to a. @note RARELY USE DIRECTLY. */
+static inline void q_qerr_merge(q_qerr_t *a, const q_qerr_t *b)
+{
+    a->n    += b->n;
+    a->sig2 += b->sig2;
+    for (unsigned int N = 0; N < a->W; N++)
+    {
+        a->q[N].sat    += b->q[N].sat;
+        a->q[N].err2   += b->q[N].err2;
+        a->q[N].max_err = b->q[N].max_err > a->q[N].max_err ? b->q[N].max_err : a->q[N].max_err;
+    }
+}
+
+/** @brief Fills snr_db and best from the sums. @note RARELY USE DIRECTLY. */
+static inline void q_qerr_finish(q_qerr_t *r)
+{
+    r->best = r->W - 1;
+    for (unsigned int N = 0; N < r->W; N++)
+    {
+        r->q[N].snr_db = r->q[N].err2 > 0.0 ? 10.0 * log10(r->sig2 / r->q[N].err2) : HUGE_VAL;
+    }
+    for (unsigned int N = r->W - 1; N-- > 0;)
+    {
+        const q_qerr_n_t *c = &r->q[N], *b = &r->q[r->best];
+        if (c->err2 < b->err2 || (c->err2 == b->err2 && c->sat < b->sat))
+        {
+            r->best = N;
+        }
+    }
+}
+
+/** @brief Arguments of a q_qerr_mt() job. @note RARELY USE DIRECTLY. */
+typedef struct
+{
+    const float32_t *src;
+    q_qerr_t        *r;
+    pthread_mutex_t  lock;
+} q_qerr_job_t;
+
+/** @brief Analyses one chunk and merges it into the job's report. @note RARELY USE DIRECTLY. */
+static inline void q_qerr_chunk(void *ctx, size_t b, size_t e)
+{
+    q_qerr_job_t *j = (q_qerr_job_t *)ctx;
+    q_qerr_t      part;
+
+    q_qerr_init(&part, j->r->W);
+    part.n = e - b;
+    q_qerr_fn()->f32(part.W, j->src + b, e - b, &part);
+    pthread_mutex_lock(&j->lock);
+    q_qerr_merge(j->r, &part);
+    pthread_mutex_unlock(&j->lock);
+}
+
+
+// Use this!
+
+/** @brief Error report of src[0 .. n) for every N of word size W (8, 16 or 32) into r. */
+static inline void q_qerr(unsigned int W, const float32_t *src, size_t n, q_qerr_t *r)
+{
+    q_qerr_init(r, W);
+    r->n = n;
+    q_qerr_fn()->f32(W, src, n, r);
+    q_qerr_finish(r);
+}
+
+/** @brief q_qerr() split over a pool; pool NULL or a small n runs on the calling thread. */
+static inline void q_qerr_mt(q_pool_t *pool, unsigned int W, const float32_t *src, size_t n, q_qerr_t *r)
+{
+    q_qerr_job_t j;
+
+    q_qerr_init(r, W);
+    j.src = src;
+    j.r   = r;
+    pthread_mutex_init(&j.lock, NULL);
+    q_pool_for(pool, q_qerr_chunk, &j, n, src, sizeof(float32_t));
+    pthread_mutex_destroy(&j.lock);
+    q_qerr_finish(r);
+}
+
+/** @brief Prints one line per N: saturations, max error, SNR; marks the recommended one. */
+static inline void q_qerr_fprint(FILE *f, const q_qerr_t *r)
+{
+    fprintf(f, "b%02u over %llu samples, best Q%u\n", r->W, (unsigned long long)r->n, r->best);
+    for (unsigned int N = 0; N < r->W; N++)
+    {
+        fprintf(f, "%c Q%-2u  sat %12llu  max_err %-13.6g  snr %8.2f dB\n", N == r->best ? '*' : ' ', N,
+                (unsigned long long)r->q[N].sat, r->q[N].max_err, r->q[N].snr_db);
+    }
+}
+
+
+#endif /* SRC_Q_QERR_H_ */
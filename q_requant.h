@@ -0,0 +1,545 @@
+/**
+ * @file    q_requant.h
+ * @brief   Fixed-to-fixed conversion between Q formats and word sizes,
+ *          integer only.
+ *
+ *          Qx_bSS_to_bDD(Ns, Nd, x) converts x from Q<Ns> in an SS-bit word
+ *          to Q<Nd> in a DD-bit word, for every SS, DD in 08, 16, 32, 64:
+ *          - Ns > Nd: rounding shift right by Ns - Nd, round half up
+ *            (floor(x / 2^k + 1/2)).
+ *          - Ns < Nd: shift left by Nd - Ns.
+ *          Result saturates to Q_MINbDD .. Q_MAXbDD.
+ *
+ *          Qx_bSS_to_bDD_array() does the same on arrays. Pairs of 8, 16 and
+ *          32 bit words run in 32-bit lanes with SSE2/AVX2/AVX-512 and narrow
+ *          with saturating packs (packssdw/packsswb, vpmovsdw/vpmovsdb);
+ *          pairs with a 64 bit word use the plain C kernel.
+ *
+ *          Example: Q31 in fix32_t to Q15 in fix16_t, no float:
+ *          @code
+ *          Qx_b32_to_b16_array(31, 15, out, in, n);
+ *          @endcode
+ */
+
+#ifndef SRC_Q_REQUANT_H_
+#define SRC_Q_REQUANT_H_
+
+
+#include "q_macros.h"
+#include "q_simd.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Requantizes x by sh = Ns - Nd bits and saturates to [lo, hi].
+ *        Reference for all kernels. @note RARELY USE DIRECTLY.
+ */
+static inline int64_t q_requant_i64(int64_t x, int sh, int64_t lo, int64_t hi)
+{
+    if (sh > 0)
+    {
+        /* Same as (x + 2^(sh-1)) >> sh, without the overflow. */
+        x = (x >> sh) + ((x >> (sh - 1)) & 1);
+    }
+    else if (sh < 0)
+    {
+        int s = -sh;
+        if (x > (hi >> s))
+        {
+            return hi;
+        }
+        if (x < -(int64_t)(((uint64_t)hi + 1U) >> s))
+        {
+            return lo;
+        }
+        x = (int64_t)((uint64_t)x << s);
+    }
+    return x > hi ? hi : (x < lo ? lo : x);
+}
+
+
+// Scalar, all 16 word pairs: Qx_b08_to_b08() .. Qx_b64_to_b64().
+
+#define Q_REQUANT_SCALAR(SW, DW, ST, DT)                                                    \
+    /** @brief Converts Q<Ns> SW-bit to Q<Nd> DW-bit with rounding and saturation. */       \
+    static inline DT Qx_b##SW##_to_b##DW(unsigned int Ns, unsigned int Nd, ST x)            \
+    {                                                                                       \
+        return (DT)q_requant_i64(x, (int)Ns - (int)Nd, Q_MINb##DW, Q_MAXb##DW);             \
+    }                                                                                       \
+    /** @brief Plain C array form of Qx_bSW_to_bDW(). @note RARELY USE DIRECTLY. */         \
+    static inline void q_b##SW##_to_b##DW##_c(unsigned int Ns, unsigned int Nd,             \
+                                              DT *dst, const ST *src, size_t n)             \
+    {                                                                                       \
+        for (size_t i = 0; i < n; i++)                                                      \
+        {                                                                                   \
+            dst[i] = Qx_b##SW##_to_b##DW(Ns, Nd, src[i]);                                   \
+        }                                                                                   \
+    }
+
+Q_REQUANT_SCALAR(08, 08, fix8_t,  fix8_t )
+Q_REQUANT_SCALAR(08, 16, fix8_t,  fix16_t)
+Q_REQUANT_SCALAR(08, 32, fix8_t,  fix32_t)
+Q_REQUANT_SCALAR(08, 64, fix8_t,  fix64_t)
+Q_REQUANT_SCALAR(16, 08, fix16_t, fix8_t )
+Q_REQUANT_SCALAR(16, 16, fix16_t, fix16_t)
+Q_REQUANT_SCALAR(16, 32, fix16_t, fix32_t)
+Q_REQUANT_SCALAR(16, 64, fix16_t, fix64_t)
+Q_REQUANT_SCALAR(32, 08, fix32_t, fix8_t )
+Q_REQUANT_SCALAR(32, 16, fix32_t, fix16_t)
+Q_REQUANT_SCALAR(32, 32, fix32_t, fix32_t)
+Q_REQUANT_SCALAR(32, 64, fix32_t, fix64_t)
+Q_REQUANT_SCALAR(64, 08, fix64_t, fix8_t )
+Q_REQUANT_SCALAR(64, 16, fix64_t, fix16_t)
+Q_REQUANT_SCALAR(64, 32, fix64_t, fix32_t)
+Q_REQUANT_SCALAR(64, 64, fix64_t, fix64_t)
+
+
+/*
+ * SIMD: 8/16/32 bit words only. Source is sign extended to 32-bit lanes, shifted
+ * like q_requant_i64(), and narrowed with saturating packs. Shifts are at most 30
+ * bits here (Ns <= 31, Nd >= 1), so 32-bit lanes never overflow. Left shifts that
+ * would overflow the destination are replaced by the limit with compare masks.
+ */
+
+/** @brief Per-call constants for the 32-bit lane requantize step. @note RARELY USE DIRECTLY. */
+typedef struct
+{
+    int     sh;         /**< Ns - Nd. */
+    int32_t thr_hi;     /**< Left shift: larger x saturate to hi. */
+    int32_t thr_lo;     /**< Left shift: smaller x saturate to lo. */
+    int32_t hi;         /**< Q_MAXbDD. */
+    int32_t lo;         /**< Q_MINbDD. */
+} q_requant_par_t;
+
+/** @brief Fills q_requant_par_t for destination limits lo, hi. @note RARELY USE DIRECTLY. */
+static inline q_requant_par_t q_requant_par(unsigned int Ns, unsigned int Nd, int32_t lo, int32_t hi)
+{
+    q_requant_par_t p;
+    p.sh     = (int)Ns - (int)Nd;
+    p.hi     = hi;
+    p.lo     = lo;
+    p.thr_hi = p.sh < 0 ? (int32_t)(hi >> -p.sh) : hi;
+    p.thr_lo = p.sh < 0 ? -(int32_t)(((uint32_t)hi + 1U) >> -p.sh) : lo;
+    return p;
+}
+
+
+#if Q_SIMD_SSE2
+Q_TARGET_SSE2_BEGIN
+
+/** @brief q_requant_i64() on 4 lanes, result still 32 bit. */
+static inline __m128i q_requant_epi32_sse2(__m128i x, const q_requant_par_t *p)
+{
+    if (p->sh > 0)
+    {
+        __m128i r = _mm_sra_epi32(x, _mm_cvtsi32_si128(p->sh));
+        __m128i h = _mm_and_si128(_mm_sra_epi32(x, _mm_cvtsi32_si128(p->sh - 1)), _mm_set1_epi32(1));
+        return _mm_add_epi32(r, h);
+    }
+    if (p->sh < 0)
+    {
+        __m128i r  = _mm_sll_epi32(x, _mm_cvtsi32_si128(-p->sh));
+        __m128i mh = _mm_cmpgt_epi32(x, _mm_set1_epi32(p->thr_hi));
+        __m128i ml = _mm_cmplt_epi32(x, _mm_set1_epi32(p->thr_lo));
+        r = _mm_andnot_si128(_mm_or_si128(mh, ml), r);
+        return _mm_or_si128(r, _mm_or_si128(_mm_and_si128(mh, _mm_set1_epi32(p->hi)),
+                                            _mm_and_si128(ml, _mm_set1_epi32(p->lo))));
+    }
+    return x;
+}
+
+/* Load 16 elements as 4 x 4 int32 lanes. */
+static inline void q_load16_b08_sse2(__m128i x[4], const fix8_t *s)
+{
+    __m128i v  = _mm_loadu_si128((const __m128i *)s);
+    __m128i lo = _mm_srai_epi16(_mm_unpacklo_epi8(v, v), 8);
+    __m128i hi = _mm_srai_epi16(_mm_unpackhi_epi8(v, v), 8);
+    x[0] = _mm_srai_epi32(_mm_unpacklo_epi16(lo, lo), 16);
+    x[1] = _mm_srai_epi32(_mm_unpackhi_epi16(lo, lo), 16);
+    x[2] = _mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 16);
+    x[3] = _mm_srai_epi32(_mm_unpackhi_epi16(hi, hi), 16);
+}
+
+static inline void q_load16_b16_sse2(__m128i x[4], const fix16_t *s)
+{
+    __m128i a = _mm_loadu_si128((const __m128i *)s);
+    __m128i b = _mm_loadu_si128((const __m128i *)(s + 8));
+    x[0] = _mm_srai_epi32(_mm_unpacklo_epi16(a, a), 16);
+    x[1] = _mm_srai_epi32(_mm_unpackhi_epi16(a, a), 16);
+    x[2] = _mm_srai_epi32(_mm_unpacklo_epi16(b, b), 16);
+    x[3] = _mm_srai_epi32(_mm_unpackhi_epi16(b, b), 16);
+}
+
+static inline void q_load16_b32_sse2(__m128i x[4], const fix32_t *s)
+{
+    for (int k = 0; k < 4; k++)
+    {
+        x[k] = _mm_loadu_si128((const __m128i *)(s + 4 * k));
+    }
+}
+
+/* Store 4 x 4 int32 lanes as 16 elements, saturating. */
+static inline void q_store16_b08_sse2(fix8_t *d, const __m128i r[4])
+{
+    _mm_storeu_si128((__m128i *)d, _mm_packs_epi16(_mm_packs_epi32(r[0], r[1]), _mm_packs_epi32(r[2], r[3])));
+}
+
+static inline void q_store16_b16_sse2(fix16_t *d, const __m128i r[4])
+{
+    _mm_storeu_si128((__m128i *)d,       _mm_packs_epi32(r[0], r[1]));
+    _mm_storeu_si128((__m128i *)(d + 8), _mm_packs_epi32(r[2], r[3]));
+}
+
+static inline void q_store16_b32_sse2(fix32_t *d, const __m128i r[4])
+{
+    for (int k = 0; k < 4; k++)
+    {
+        _mm_storeu_si128((__m128i *)(d + 4 * k), r[k]);
+    }
+}
+
+#define Q_REQUANT_SSE2(SW, DW, ST, DT)                                                      \
+    static inline void q_b##SW##_to_b##DW##_sse2(unsigned int Ns, unsigned int Nd,          \
+                                                 DT *dst, const ST *src, size_t n)          \
+    {                                                                                       \
+        const q_requant_par_t p = q_requant_par(Ns, Nd, Q_MINb##DW, Q_MAXb##DW);            \
+        size_t i = 0;                                                                       \
+        for (; i + 16 <= n; i += 16)                                                        \
+        {                                                                                   \
+            __m128i x[4];                                                                   \
+            q_load16_b##SW##_sse2(x, src + i);                                              \
+            for (int k = 0; k < 4; k++)                                                     \
+            {                                                                               \
+                x[k] = q_requant_epi32_sse2(x[k], &p);                                      \
+            }                                                                               \
+            q_store16_b##DW##_sse2(dst + i, x);                                             \
+        }                                                                                   \
+        q_b##SW##_to_b##DW##_c(Ns, Nd, dst + i, src + i, n - i);                            \
+    }
+
+Q_REQUANT_SSE2(08, 08, fix8_t,  fix8_t )
+Q_REQUANT_SSE2(08, 16, fix8_t,  fix16_t)
+Q_REQUANT_SSE2(08, 32, fix8_t,  fix32_t)
+Q_REQUANT_SSE2(16, 08, fix16_t, fix8_t )
+Q_REQUANT_SSE2(16, 16, fix16_t, fix16_t)
+Q_REQUANT_SSE2(16, 32, fix16_t, fix32_t)
+Q_REQUANT_SSE2(32, 08, fix32_t, fix8_t )
+Q_REQUANT_SSE2(32, 16, fix32_t, fix16_t)
+Q_REQUANT_SSE2(32, 32, fix32_t, fix32_t)
+
+Q_TARGET_END
+#endif /* Q_SIMD_SSE2 */
+
+
+#if Q_SIMD_AVX2
+Q_TARGET_AVX2_BEGIN
+
+/** @brief q_requant_i64() on 8 lanes, result still 32 bit. */
+static inline __m256i q_requant_epi32_avx2(__m256i x, const q_requant_par_t *p)
+{
+    if (p->sh > 0)
+    {
+        __m256i r = _mm256_sra_epi32(x, _mm_cvtsi32_si128(p->sh));
+        __m256i h = _mm256_and_si256(_mm256_sra_epi32(x, _mm_cvtsi32_si128(p->sh - 1)), _mm256_set1_epi32(1));
+        return _mm256_add_epi32(r, h);
+    }
+    if (p->sh < 0)
+    {
+        __m256i r  = _mm256_sll_epi32(x, _mm_cvtsi32_si128(-p->sh));
+        __m256i mh = _mm256_cmpgt_epi32(x, _mm256_set1_epi32(p->thr_hi));
+        __m256i ml = _mm256_cmpgt_epi32(_mm256_set1_epi32(p->thr_lo), x);
+        r = _mm256_blendv_epi8(r, _mm256_set1_epi32(p->hi), mh);
+        return _mm256_blendv_epi8(r, _mm256_set1_epi32(p->lo), ml);
+    }
+    return x;
+}
+
+/* Load 32 elements as 4 x 8 int32 lanes. */
+static inline void q_load32_b08_avx2(__m256i x[4], const fix8_t *s)
+{
+    for (int k = 0; k < 4; k++)
+    {
+        x[k] = _mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i *)(s + 8 * k)));
+    }
+}
+
+static inline void q_load32_b16_avx2(__m256i x[4], const fix16_t *s)
+{
+    for (int k = 0; k < 4; k++)
+    {
+        x[k] = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(s + 8 * k)));
+    }
+}
+
+static inline void q_load32_b32_avx2(__m256i x[4], const fix32_t *s)
+{
+    for (int k = 0; k < 4; k++)
+    {
+        x[k] = _mm256_loadu_si256((const __m256i *)(s + 8 * k));
+    }
+}
+
+/* Store 4 x 8 int32 lanes as 32 elements, saturating. packs works per 128-bit lane, permute fixes the order. */
+static inline void q_store32_b08_avx2(fix8_t *d, const __m256i r[4])
+{
+    __m256i v = _mm256_packs_epi16(_mm256_packs_epi32(r[0], r[1]), _mm256_packs_epi32(r[2], r[3]));
+    _mm256_storeu_si256((__m256i *)d, _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7)));
+}
+
+static inline void q_store32_b16_avx2(fix16_t *d, const __m256i r[4])
+{
+    _mm256_storeu_si256((__m256i *)d,        _mm256_permute4x64_epi64(_mm256_packs_epi32(r[0], r[1]), 0xD8));
+    _mm256_storeu_si256((__m256i *)(d + 16), _mm256_permute4x64_epi64(_mm256_packs_epi32(r[2], r[3]), 0xD8));
+}
+
+static inline void q_store32_b32_avx2(fix32_t *d, const __m256i r[4])
+{
+    for (int k = 0; k < 4; k++)
+    {
+        _mm256_storeu_si256((__m256i *)(d + 8 * k), r[k]);
+    }
+}
+
+#define Q_REQUANT_AVX2(SW, DW, ST, DT)                                                      \
+    static inline void q_b##SW##_to_b##DW##_avx2(unsigned int Ns, unsigned int Nd,          \
+                                                 DT *dst, const ST *src, size_t n)          \
+    {                                                                                       \
+        const q_requant_par_t p = q_requant_par(Ns, Nd, Q_MINb##DW, Q_MAXb##DW);            \
+        size_t i = 0;                                                                       \
+        for (; i + 32 <= n; i += 32)                                                        \
+        {                                                                                   \
+            __m256i x[4];                                                                   \
+            q_load32_b##SW##_avx2(x, src + i);                                              \
+            for (int k = 0; k < 4; k++)                                                     \
+            {                                                                               \
+                x[k] = q_requant_epi32_avx2(x[k], &p);                                      \
+            }                                                                               \
+            q_store32_b##DW##_avx2(dst + i, x);                                             \
+        }                                                                                   \
+        q_b##SW##_to_b##DW##_c(Ns, Nd, dst + i, src + i, n - i);                            \
+    }
+
+Q_REQUANT_AVX2(08, 08, fix8_t,  fix8_t )
+Q_REQUANT_AVX2(08, 16, fix8_t,  fix16_t)
+Q_REQUANT_AVX2(08, 32, fix8_t,  fix32_t)
+Q_REQUANT_AVX2(16, 08, fix16_t, fix8_t )
+Q_REQUANT_AVX2(16, 16, fix16_t, fix16_t)
+Q_REQUANT_AVX2(16, 32, fix16_t, fix32_t)
+Q_REQUANT_AVX2(32, 08, fix32_t, fix8_t )
+Q_REQUANT_AVX2(32, 16, fix32_t, fix16_t)
+Q_REQUANT_AVX2(32, 32, fix32_t, fix32_t)
+
+Q_TARGET_END
+#endif /* Q_SIMD_AVX2 */
+
+
+#if Q_SIMD_AVX512
+Q_TARGET_AVX512_BEGIN
+
+/** @brief q_requant_i64() on 16 lanes, result still 32 bit. */
+static inline __m512i q_requant_epi32_avx512(__m512i x, const q_requant_par_t *p)
+{
+    if (p->sh > 0)
+    {
+        __m512i r = _mm512_sra_epi32(x, _mm_cvtsi32_si128(p->sh));
+        __m512i h = _mm512_and_si512(_mm512_sra_epi32(x, _mm_cvtsi32_si128(p->sh - 1)), _mm512_set1_epi32(1));
+        return _mm512_add_epi32(r, h);
+    }
+    if (p->sh < 0)
+    {
+        __m512i r = _mm512_sll_epi32(x, _mm_cvtsi32_si128(-p->sh));
+        r = _mm512_mask_mov_epi32(r, _mm512_cmpgt_epi32_mask(x, _mm512_set1_epi32(p->thr_hi)), _mm512_set1_epi32(p->hi));
+        return _mm512_mask_mov_epi32(r, _mm512_cmplt_epi32_mask(x, _mm512_set1_epi32(p->thr_lo)), _mm512_set1_epi32(p->lo));
+    }
+    return x;
+}
+
+/* Load 64 elements as 4 x 16 int32 lanes. */
+static inline void q_load64_b08_avx512(__m512i x[4], const fix8_t *s)
+{
+    for (int k = 0; k < 4; k++)
+    {
+        x[k] = _mm512_cvtepi8_epi32(_mm_loadu_si128((const __m128i *)(s + 16 * k)));
+    }
+}
+
+static inline void q_load64_b16_avx512(__m512i x[4], const fix16_t *s)
+{
+    for (int k = 0; k < 4; k++)
+    {
+        x[k] = _mm512_cvtepi16_epi32(_mm256_loadu_si256((const __m256i *)(s + 16 * k)));
+    }
+}
+
+static inline void q_load64_b32_avx512(__m512i x[4], const fix32_t *s)
+{
+    for (int k = 0; k < 4; k++)
+    {
+        x[k] = _mm512_loadu_si512((const void *)(s + 16 * k));
+    }
+}
+
+/* Store 4 x 16 int32 lanes as 64 elements with saturating vpmovsdb/vpmovsdw. */
+static inline void q_store64_b08_avx512(fix8_t *d, const __m512i r[4])
+{
+    for (int k = 0; k < 4; k++)
+    {
+        _mm_storeu_si128((__m128i *)(d + 16 * k), _mm512_cvtsepi32_epi8(r[k]));
+    }
+}
+
+static inline void q_store64_b16_avx512(fix16_t *d, const __m512i r[4])
+{
+    for (int k = 0; k < 4; k++)
+    {
+        _mm256_storeu_si256((__m256i *)(d + 16 * k), _mm512_cvtsepi32_epi16(r[k]));
+    }
+}
+
+static inline void q_store64_b32_avx512(fix32_t *d, const __m512i r[4])
+{
+    for (int k = 0; k < 4; k++)
+    {
+        _mm512_storeu_si512((void *)(d + 16 * k), r[k]);
+    }
+}
+
+#define Q_REQUANT_AVX512(SW, DW, ST, DT)                                                    \
+    static inline void q_b##SW##_to_b##DW##_avx512(unsigned int Ns, unsigned int Nd,        \
+                                                   DT *dst, const ST *src, size_t n)        \
+    {                                                                                       \
+        const q_requant_par_t p = q_requant_par(Ns, Nd, Q_MINb##DW, Q_MAXb##DW);            \
+        size_t i = 0;                                                                       \
+        for (; i + 64 <= n; i += 64)                                                        \
+        {                                                                                   \
+            __m512i x[4];                                                                   \
+            q_load64_b##SW##_avx512(x, src + i);                                            \
+            for (int k = 0; k < 4; k++)                                                     \
+            {                                                                               \
+                x[k] = q_requant_epi32_avx512(x[k], &p);                                    \
+            }                                                                               \
+            q_store64_b##DW##_avx512(dst + i, x);                                           \
+        }                                                                                   \
+        q_b##SW##_to_b##DW##_c(Ns, Nd, dst + i, src + i, n - i);                            \
+    }
+
+Q_REQUANT_AVX512(08, 08, fix8_t,  fix8_t )
+Q_REQUANT_AVX512(08, 16, fix8_t,  fix16_t)
+Q_REQUANT_AVX512(08, 32, fix8_t,  fix32_t)
+Q_REQUANT_AVX512(16, 08, fix16_t, fix8_t )
+Q_REQUANT_AVX512(16, 16, fix16_t, fix16_t)
+Q_REQUANT_AVX512(16, 32, fix16_t, fix32_t)
+Q_REQUANT_AVX512(32, 08, fix32_t, fix8_t )
+Q_REQUANT_AVX512(32, 16, fix32_t, fix16_t)
+Q_REQUANT_AVX512(32, 32, fix32_t, fix32_t)
+
+Q_TARGET_END
+#endif /* Q_SIMD_AVX512 */
+
+
+// Kernel table for the 8/16/32-bit pairs, bound once per translation unit to the tier from q_isa().
+
+typedef struct
+{
+    void (*b08_to_b08)(unsigned int Ns, unsigned int Nd, fix8_t  *dst, const fix8_t  *src, size_t n);
+    void (*b08_to_b16)(unsigned int Ns, unsigned int Nd, fix16_t *dst, const fix8_t  *src, size_t n);
+    void (*b08_to_b32)(unsigned int Ns, unsigned int Nd, fix32_t *dst, const fix8_t  *src, size_t n);
+    void (*b16_to_b08)(unsigned int Ns, unsigned int Nd, fix8_t  *dst, const fix16_t *src, size_t n);
+    void (*b16_to_b16)(unsigned int Ns, unsigned int Nd, fix16_t *dst, const fix16_t *src, size_t n);
+    void (*b16_to_b32)(unsigned int Ns, unsigned int Nd, fix32_t *dst, const fix16_t *src, size_t n);
+    void (*b32_to_b08)(unsigned int Ns, unsigned int Nd, fix8_t  *dst, const fix32_t *src, size_t n);
+    void (*b32_to_b16)(unsigned int Ns, unsigned int Nd, fix16_t *dst, const fix32_t *src, size_t n);
+    void (*b32_to_b32)(unsigned int Ns, unsigned int Nd, fix32_t *dst, const fix32_t *src, size_t n);
+    int    bound;
+} q_requant_fn_t;
+
+static q_requant_fn_t q_requant_k;
+
+#define Q_REQUANT_SET(K, ISA)                                                               \
+    do                                                                                      \
+    {                                                                                       \
+        (K).b08_to_b08 = q_b08_to_b08_##ISA; (K).b08_to_b16 = q_b08_to_b16_##ISA;           \
+        (K).b08_to_b32 = q_b08_to_b32_##ISA; (K).b16_to_b08 = q_b16_to_b08_##ISA;           \
+        (K).b16_to_b16 = q_b16_to_b16_##ISA; (K).b16_to_b32 = q_b16_to_b32_##ISA;           \
+        (K).b32_to_b08 = q_b32_to_b08_##ISA; (K).b32_to_b16 = q_b32_to_b16_##ISA;           \
+        (K).b32_to_b32 = q_b32_to_b32_##ISA;                                                \
+    } while (0)
+
+/** @brief Fills q_requant_k for q_isa(). Runs before main() where supported. @note RARELY USE DIRECTLY. */
+static Q_CONSTRUCTOR void q_requant_bind(void)
+{
+    q_isa_t        isa = q_isa();
+    q_requant_fn_t k;
+
+    (void)isa;
+    Q_REQUANT_SET(k, c);
+#if Q_SIMD_SSE2
+    if (isa >= Q_ISA_SSE2)
+    {
+        Q_REQUANT_SET(k, sse2);
+    }
+#endif
+#if Q_SIMD_AVX2
+    if (isa >= Q_ISA_AVX2)
+    {
+        Q_REQUANT_SET(k, avx2);
+    }
+#endif
+#if Q_SIMD_AVX512
+    if (isa >= Q_ISA_AVX512)
+    {
+        Q_REQUANT_SET(k, avx512);
+    }
+#endif
+    k.bound     = 1;
+    q_requant_k = k;
+}
+
+/** @brief Bound kernel table. Binds on first use if the constructor has not run yet. @note RARELY USE DIRECTLY. */
+static inline const q_requant_fn_t *q_requant_fn(void)
+{
+    if (!q_requant_k.bound)
+    {
+        q_requant_bind();
+    }
+    return &q_requant_k;
+}
+
+#define Q_REQUANT_FN(SW, DW)    q_requant_fn()->b##SW##_to_b##DW
+
+
+// Use this!
+
+#define Q_REQUANT_ARRAY(SW, DW, ST, DT, KERNEL)                                             \
+    /** @brief Converts n values from Q<Ns> SW-bit to Q<Nd> DW-bit, same as Qx_bSW_to_bDW(). */ \
+    static inline void Qx_b##SW##_to_b##DW##_array(unsigned int Ns, unsigned int Nd,        \
+                                                   DT *dst, const ST *src, size_t n)        \
+    {                                                                                       \
+        KERNEL(Ns, Nd, dst, src, n);                                                        \
+    }
+
+Q_REQUANT_ARRAY(08, 08, fix8_t,  fix8_t,  Q_REQUANT_FN(08, 08))
+Q_REQUANT_ARRAY(08, 16, fix8_t,  fix16_t, Q_REQUANT_FN(08, 16))
+Q_REQUANT_ARRAY(08, 32, fix8_t,  fix32_t, Q_REQUANT_FN(08, 32))
+Q_REQUANT_ARRAY(08, 64, fix8_t,  fix64_t, q_b08_to_b64_c)
+Q_REQUANT_ARRAY(16, 08, fix16_t, fix8_t,  Q_REQUANT_FN(16, 08))
+Q_REQUANT_ARRAY(16, 16, fix16_t, fix16_t, Q_REQUANT_FN(16, 16))
+Q_REQUANT_ARRAY(16, 32, fix16_t, fix32_t, Q_REQUANT_FN(16, 32))
+Q_REQUANT_ARRAY(16, 64, fix16_t, fix64_t, q_b16_to_b64_c)
+Q_REQUANT_ARRAY(32, 08, fix32_t, fix8_t,  Q_REQUANT_FN(32, 08))
+Q_REQUANT_ARRAY(32, 16, fix32_t, fix16_t, Q_REQUANT_FN(32, 16))
+Q_REQUANT_ARRAY(32, 32, fix32_t, fix32_t, Q_REQUANT_FN(32, 32))
+Q_REQUANT_ARRAY(32, 64, fix32_t, fix64_t, q_b32_to_b64_c)
+Q_REQUANT_ARRAY(64, 08, fix64_t, fix8_t,  q_b64_to_b08_c)
+Q_REQUANT_ARRAY(64, 16, fix64_t, fix16_t, q_b64_to_b16_c)
+Q_REQUANT_ARRAY(64, 32, fix64_t, fix32_t, q_b64_to_b32_c)
+Q_REQUANT_ARRAY(64, 64, fix64_t, fix64_t, q_b64_to_b64_c)
+
+// Most used.
+#define Q31b32_to_Q15b16_array(dst, src, n)  Qx_b32_to_b16_array(31, 15, dst, src, n) /**< Q31 32-bit to Q15 16-bit. */
+#define Q15b16_to_Q31b32_array(dst, src, n)  Qx_b16_to_b32_array(15, 31, dst, src, n) /**< Q15 16-bit to Q31 32-bit. */
+#define Q15b16_to_Q7b8_array(dst, src, n)    Qx_b16_to_b08_array(15,  7, dst, src, n) /**< Q15 16-bit to Q7 8-bit. */
+#define Q7b8_to_Q15b16_array(dst, src, n)    Qx_b08_to_b16_array( 7, 15, dst, src, n) /**< Q7 8-bit to Q15 16-bit. */
+
+
+#endif /* SRC_Q_REQUANT_H_ */
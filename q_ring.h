@@ -0,0 +1,413 @@
+/**
+ * @file    q_ring.h
+ * @brief   Lock-free single-producer/single-consumer ring of sample blocks,
+ *          float in, Q15/Q31 (any 16 or 32-bit Q<N>) out, with per-block
+ *          latency statistics.
+ *
+ *          q_ring_create() allocates and touches every block up front; the
+ *          hot path then does no allocation, no locking and no system call
+ *          besides clock_gettime() (with Q_RING_TIMING).
+ *          - Producer (capture thread): q_ring_write_begin() hands out the
+ *            float area of the next free block, q_ring_write_end() commits n
+ *            samples and stamps the block. q_ring_push() does both with a
+ *            copy.
+ *          - Consumer (DSP thread): q_ring_read_begin() converts the oldest
+ *            committed block with Qx_bxx_array() into its word area and
+ *            returns it, q_ring_read_end() gives the block back.
+ *          Both return NULL instead of waiting, so each side keeps its own
+ *          policy (spin, drop, sleep).
+ *
+ *          Block areas are 64-byte aligned and padded to whole lines; the
+ *          producer and consumer positions each have a cache line, and each
+ *          side keeps a copy of the other's so it only reads the shared line
+ *          when the ring looks full or empty.
+ *
+ *          Latency of a block is from q_ring_write_end() to the end of its
+ *          conversion in q_ring_read_begin(), in ns on CLOCK_MONOTONIC.
+ *          Timing is on (Q_RING_TIMING 1) when <time.h> declares
+ *          CLOCK_MONOTONIC, i.e. with _POSIX_C_SOURCE >= 199309L (default
+ *          with gnu99). Under plain -std=c99, or with -DQ_RING_TIMING=0, the
+ *          ring works the same and only the latency and conversion times
+ *          stay 0.
+ *          q_ring_stats() returns min, max, mean, the conversion part, a log2
+ *          histogram for q_ring_pct() and how often the producer found the
+ *          ring full.
+ *
+ *          @code
+ *          q_ring_t *r = Q15_ring_create(256, 8);      // 8 blocks of 256 samples
+ *          // capture thread
+ *          float32_t *f = q_ring_write_begin(r);
+ *          if (f != NULL) { fill(f, 256); q_ring_write_end(r, 256); }
+ *          // DSP thread
+ *          size_t n;
+ *          const fix16_t *q = (const fix16_t *)q_ring_read_begin(r, &n);
+ *          if (q != NULL) { process(q, n); q_ring_read_end(r); }
+ *          q_ring_stats_t s;
+ *          q_ring_stats(r, &s);                        // from the DSP thread
+ *          q_ring_fprint(stderr, &s);
+ *          @endcode
+ *
+ * @note    Exactly one producer and one consumer thread. q_ring_stats() and
+ *          q_ring_stats_reset() belong to the consumer.
+ * @note    GCC/clang __atomic builtins.
+ */
+
+#ifndef SRC_Q_RING_H_
+#define SRC_Q_RING_H_
+
+
+#include "q_array.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifndef Q_RING_TIMING
+#if defined(CLOCK_MONOTONIC)
+#define Q_RING_TIMING   1           /**< Stamp blocks with clock_gettime() for the latency statistics. */
+#else
+#define Q_RING_TIMING   0
+#endif
+#endif
+
+#define Q_RING_LINE     64U         /**< Cache line bytes. */
+#define Q_RING_HIST     32U         /**< Latency histogram bins, bin k counts [2^(k-1), 2^k) ns. */
+
+/** @brief Position of one side, with its copy of the other side's, one cache line. */
+typedef struct
+{
+    size_t   pos;                                       /**< Blocks committed (producer) or released (consumer). */
+    size_t   other;                                     /**< Last seen pos of the other side. */
+    size_t   held;                                      /**< Consumer: block at pos converted, not yet released. */
+    uint64_t miss;                                      /**< Ring found full (producer) or empty (consumer). */
+    char     pad[Q_RING_LINE - 3 * sizeof(size_t) - sizeof(uint64_t)];
+} q_ring_end_t;
+
+/** @brief Block header, written by the producer on commit, one cache line. */
+typedef struct
+{
+    uint64_t t;                                         /**< Commit time, ns. */
+    size_t   n;                                         /**< Samples in the block. */
+    char     pad[Q_RING_LINE - sizeof(uint64_t) - sizeof(size_t)];
+} q_ring_hdr_t;
+
+/** @brief Latency statistics, all times in ns. */
+typedef struct
+{
+    uint64_t blocks;                /**< Blocks converted. */
+    uint64_t full;                  /**< q_ring_write_begin() / q_ring_push() calls that found the ring full. */
+    uint64_t empty;                 /**< q_ring_read_begin() calls that found the ring empty. */
+    uint64_t lat_min;               /**< Shortest commit to converted. */
+    uint64_t lat_max;               /**< Longest commit to converted. */
+    uint64_t lat_sum;
+    uint64_t conv_max;              /**< Longest conversion alone. */
+    uint64_t conv_sum;
+    uint64_t hist[Q_RING_HIST];     /**< Latency histogram, see Q_RING_HIST. */
+} q_ring_stats_t;
+
+/**
+ * @brief Ring of nblocks blocks of block samples. prod and cons lead the
+ *        struct on their own lines; the rest is read-only or consumer-owned.
+ */
+typedef struct
+{
+    q_ring_end_t    prod;
+    q_ring_end_t    cons;
+    q_ring_stats_t  stats;      /**< Consumer-owned, prod.miss is added in q_ring_stats(). */
+    char            pad[Q_RING_LINE];
+
+    unsigned int    W;          /**< Word bits, 16 or 32. */
+    unsigned int    N;          /**< Q format of the words. */
+    size_t          block;      /**< Samples per block. */
+    size_t          mask;       /**< nblocks - 1. */
+    size_t          fstride;    /**< Floats between block float areas. */
+    size_t          qstride;    /**< Bytes between block word areas. */
+    q_ring_hdr_t   *hdr;
+    float32_t      *f;
+    unsigned char  *q;
+    void           *mem;
+} q_ring_t;
+
+
+/** @brief Bytes rounded up to whole cache lines. @note RARELY USE DIRECTLY. */
+#define Q_RING_ROUND(x)     ( ((x) + Q_RING_LINE - 1U) & ~(size_t)(Q_RING_LINE - 1U) )
+
+/** @brief CLOCK_MONOTONIC in ns, 0 without Q_RING_TIMING. @note RARELY USE DIRECTLY. */
+static inline uint64_t q_ring_now(void)
+{
+#if Q_RING_TIMING
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#else
+    return 0U;
+#endif
+}
+
+/** @brief Histogram bin of a latency. @note RARELY USE DIRECTLY. */
+static inline unsigned int q_ring_bin(uint64_t ns)
+{
+    unsigned int k = ns == 0 ? 0U : 64U - (unsigned int)__builtin_clzll(ns);
+    return k < Q_RING_HIST ? k : Q_RING_HIST - 1U;
+}
+
+/**
+ * @brief Frees a ring from q_ring_create(). NULL is ignored. Both sides must be done with it.
+ */
+static inline void q_ring_destroy(q_ring_t *r)
+{
+    if (r != NULL)
+    {
+        free(r->mem);
+    }
+}
+
+/**
+ * @brief Ring of nblocks (power of two, at least 2) blocks of block samples converting to
+ *        W-bit (16 or 32) Q<N> words. All memory is allocated and touched here.
+ * @return NULL on bad arguments or out of memory.
+ */
+static inline q_ring_t *q_ring_create(unsigned int W, unsigned int N, size_t block, size_t nblocks)
+{
+    if ((W != 16U && W != 32U) || N >= W || block == 0 || block > SIZE_MAX / 64U ||
+        nblocks < 2 || nblocks > SIZE_MAX / 1024U || (nblocks & (nblocks - 1U)) != 0)
+    {
+        return NULL;
+    }
+
+    size_t rbytes = Q_RING_ROUND(sizeof(q_ring_t));
+    size_t hbytes = nblocks * sizeof(q_ring_hdr_t);
+    size_t fbytes = Q_RING_ROUND(block * sizeof(float32_t));
+    size_t qbytes = Q_RING_ROUND(block * (W / 8U));
+
+    if (fbytes + qbytes > (SIZE_MAX - rbytes - hbytes - Q_RING_LINE) / nblocks)
+    {
+        return NULL;
+    }
+
+    size_t total = rbytes + hbytes + nblocks * (fbytes + qbytes) + Q_RING_LINE;
+    void  *mem   = malloc(total);
+
+    if (mem == NULL)
+    {
+        return NULL;
+    }
+    memset(mem, 0, total);      /* Fault every page in now, not on the first blocks. */
+
+    unsigned char *base = (unsigned char *)(((uintptr_t)mem + Q_RING_LINE - 1) & ~(uintptr_t)(Q_RING_LINE - 1));
+    q_ring_t      *r    = (q_ring_t *)base;
+
+    r->W       = W;
+    r->N       = N;
+    r->block   = block;
+    r->mask    = nblocks - 1U;
+    r->fstride = fbytes / sizeof(float32_t);
+    r->qstride = qbytes;
+    r->hdr     = (q_ring_hdr_t *)(base + rbytes);
+    r->f       = (float32_t *)(base + rbytes + hbytes);
+    r->q       = base + rbytes + hbytes + nblocks * fbytes;
+    r->mem     = mem;
+    r->stats.lat_min = UINT64_MAX;
+    return r;
+}
+
+/** @brief Samples per block. */
+static inline size_t q_ring_block(const q_ring_t *r)
+{
+    return r->block;
+}
+
+
+// Producer side.
+
+/**
+ * @brief Float area (q_ring_block() samples) of the next free block, NULL if the ring is full.
+ *        Calling it again before q_ring_write_end() returns the same block.
+ */
+static inline float32_t *q_ring_write_begin(q_ring_t *r)
+{
+    size_t head = r->prod.pos;
+
+    if (head - r->prod.other > r->mask)
+    {
+        r->prod.other = __atomic_load_n(&r->cons.pos, __ATOMIC_ACQUIRE);
+        if (head - r->prod.other > r->mask)
+        {
+            __atomic_fetch_add(&r->prod.miss, 1, __ATOMIC_RELAXED);
+            return NULL;
+        }
+    }
+    return r->f + (head & r->mask) * r->fstride;
+}
+
+/**
+ * @brief Commits the block from q_ring_write_begin() with n samples (at most q_ring_block()).
+ */
+static inline void q_ring_write_end(q_ring_t *r, size_t n)
+{
+    size_t        head = r->prod.pos;
+    q_ring_hdr_t *h    = &r->hdr[head & r->mask];
+
+    h->n = n < r->block ? n : r->block;
+    h->t = q_ring_now();
+    __atomic_store_n(&r->prod.pos, head + 1U, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Copies n samples (at most q_ring_block()) into the next block and commits it.
+ * @return 0, or -1 if the ring is full and nothing was written.
+ */
+static inline int q_ring_push(q_ring_t *r, const float32_t *src, size_t n)
+{
+    float32_t *f = q_ring_write_begin(r);
+
+    if (f == NULL)
+    {
+        return -1;
+    }
+    n = n < r->block ? n : r->block;
+    memcpy(f, src, n * sizeof(float32_t));
+    q_ring_write_end(r, n);
+    return 0;
+}
+
+
+// Consumer side.
+
+/**
+ * @brief Converts the oldest committed block and returns its words (fix16_t or fix32_t,
+ *        64-byte aligned), *n set to the sample count. NULL if the ring is empty.
+ *        The words stay valid until q_ring_read_end(); calling it again before that
+ *        returns the same block without converting or counting it again.
+ */
+static inline const void *q_ring_read_begin(q_ring_t *r, size_t *n)
+{
+    size_t tail = r->cons.pos;
+
+    if (r->cons.held)
+    {
+        *n = r->hdr[tail & r->mask].n;
+        return r->q + (tail & r->mask) * r->qstride;
+    }
+    if (tail == r->cons.other)
+    {
+        r->cons.other = __atomic_load_n(&r->prod.pos, __ATOMIC_ACQUIRE);
+        if (tail == r->cons.other)
+        {
+            r->cons.miss++;
+            return NULL;
+        }
+    }
+
+    size_t              slot = tail & r->mask;
+    const q_ring_hdr_t *h    = &r->hdr[slot];
+    const float32_t    *f    = r->f + slot * r->fstride;
+    unsigned char      *q    = r->q + slot * r->qstride;
+    uint64_t            t0   = q_ring_now();
+
+    if (r->W == 16U)
+    {
+        Qx_b16_array(r->N, (fix16_t *)q, f, h->n);
+    }
+    else
+    {
+        Qx_b32_array(r->N, (fix32_t *)q, f, h->n);
+    }
+
+    uint64_t        t1  = q_ring_now();
+    uint64_t        lat = t1 > h->t ? t1 - h->t : 0U;
+    q_ring_stats_t *s   = &r->stats;
+
+    s->blocks++;
+    s->lat_min   = lat < s->lat_min ? lat : s->lat_min;
+    s->lat_max   = lat > s->lat_max ? lat : s->lat_max;
+    s->lat_sum  += lat;
+    s->conv_max  = t1 - t0 > s->conv_max ? t1 - t0 : s->conv_max;
+    s->conv_sum += t1 - t0;
+    s->hist[q_ring_bin(lat)]++;
+
+    r->cons.held = 1;
+    *n = h->n;
+    return q;
+}
+
+/** @brief Releases the block from q_ring_read_begin() to the producer. Does nothing if no block is held. */
+static inline void q_ring_read_end(q_ring_t *r)
+{
+    if (r->cons.held)
+    {
+        r->cons.held = 0;
+        __atomic_store_n(&r->cons.pos, r->cons.pos + 1U, __ATOMIC_RELEASE);
+    }
+}
+
+
+// Statistics, consumer side.
+
+/** @brief Copies the statistics so far. lat_min is UINT64_MAX before the first block. */
+static inline void q_ring_stats(const q_ring_t *r, q_ring_stats_t *s)
+{
+    *s       = r->stats;
+    s->full  = __atomic_load_n(&r->prod.miss, __ATOMIC_RELAXED);
+    s->empty = r->cons.miss;
+}
+
+/** @brief Starts the statistics over. */
+static inline void q_ring_stats_reset(q_ring_t *r)
+{
+    memset(&r->stats, 0, sizeof(r->stats));
+    r->stats.lat_min = UINT64_MAX;
+    r->cons.miss     = 0;
+    __atomic_store_n(&r->prod.miss, 0, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Latency bound in ns met by at least a fraction p (0 .. 1) of the blocks, from the
+ *        histogram: a power of two, at most 2x the true percentile. lat_max for p >= 1.
+ */
+static inline uint64_t q_ring_pct(const q_ring_stats_t *s, float64_t p)
+{
+    float64_t want = (p > 0.0 ? p : 0.0) * (float64_t)s->blocks;
+    uint64_t  need, seen = 0;
+
+    if (p >= 1.0 || s->blocks == 0)
+    {
+        return s->blocks == 0 ? 0U : s->lat_max;
+    }
+    need  = (uint64_t)want;
+    need += (float64_t)need < want;
+    for (unsigned int k = 0; k < Q_RING_HIST; k++)
+    {
+        seen += s->hist[k];
+        if (seen >= need)
+        {
+            uint64_t bound = k + 1U < Q_RING_HIST ? 1ULL << k : s->lat_max;
+            return bound < s->lat_max ? bound : s->lat_max;
+        }
+    }
+    return s->lat_max;
+}
+
+/** @brief Prints block count, full/empty counts, latency min/mean/p99/max and conversion time. */
+static inline void q_ring_fprint(FILE *f, const q_ring_stats_t *s)
+{
+    uint64_t b = s->blocks != 0 ? s->blocks : 1U;
+
+    fprintf(f, "%llu blocks, full %llu, empty %llu\n", (unsigned long long)s->blocks,
+            (unsigned long long)s->full, (unsigned long long)s->empty);
+    fprintf(f, "latency ns  min %llu  mean %llu  p99 <= %llu  max %llu\n",
+            (unsigned long long)(s->blocks != 0 ? s->lat_min : 0U), (unsigned long long)(s->lat_sum / b),
+            (unsigned long long)q_ring_pct(s, 0.99), (unsigned long long)s->lat_max);
+    fprintf(f, "convert ns  mean %llu  max %llu\n", (unsigned long long)(s->conv_sum / b),
+            (unsigned long long)s->conv_max);
+}
+
+
+// Most used formats.
+#define Q15_ring_create(block, nblocks)     q_ring_create(16, 15, block, nblocks)   /**< Ring converting to 16-bit Q15. */
+#define Q31_ring_create(block, nblocks)     q_ring_create(32, 31, block, nblocks)   /**< Ring converting to 32-bit Q31. */
+
+
+#endif /* SRC_Q_RING_H_ */
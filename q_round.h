@@ -0,0 +1,634 @@
+/**
+ * @file    q_round.h
+ * @brief   Float-to-fixed conversion with selectable rounding, 8, 16, 32 and
+ *          64 bit words.
+ *
+ *          Qx_bxx() from q_macros.h always truncates toward zero. Qx_bxx_r()
+ *          and Qx_bxx_array_r() take a q_round_t instead; saturation is the
+ *          same as Qx_bxx(). Q_ROUND_TRUNC gives exactly Qx_bxx().
+ *
+ *          Stochastic rounding is counter based: element i of a batch uses
+ *          random bits q_hash32(ctr + i), so scalar, SIMD and chunked calls
+ *          give identical results for the same ctr.
+ *
+ * @note    The SSE2/AVX2 kernels round to nearest even with cvtps2dq, which
+ *          follows MXCSR. Results match the scalar form only with the
+ *          default MXCSR rounding mode. AVX-512 uses embedded rounding and
+ *          does not depend on MXCSR.
+ * @note    Do not build with -ffast-math, the scalar form relies on exact
+ *          float subtraction.
+ */
+
+#ifndef SRC_Q_ROUND_H_
+#define SRC_Q_ROUND_H_
+
+
+#include "q_array.h"
+#include <stdint.h>
+
+/**
+ * @brief Rounding applied to x*2^N before saturation.
+ */
+typedef enum
+{
+    Q_ROUND_TRUNC = 0,          /**< Toward zero, same as Qx_bxx(). */
+    Q_ROUND_NEAREST_EVEN,       /**< To nearest, ties to even. */
+    Q_ROUND_HALF_AWAY,          /**< To nearest, ties away from zero. */
+    Q_ROUND_FLOOR,              /**< Toward minus infinity. */
+    Q_ROUND_STOCHASTIC          /**< Up with probability equal to the fraction. */
+} q_round_t;
+
+/** @brief Counter-based 32-bit hash (lowbias32), random bits for Q_ROUND_STOCHASTIC. */
+static inline uint32_t q_hash32(uint32_t x)
+{
+    x ^= x >> 16;
+    x *= 0x7FEB352DU;
+    x ^= x >> 15;
+    x *= 0x846CA68BU;
+    x ^= x >> 16;
+    return x;
+}
+
+/**
+ * @brief Rounds scaled value s to integer. @note RARELY USE DIRECTLY.
+ *        s must already be clamped to [-2^31, 2^31 - 128]. Reference for all
+ *        SIMD kernels: trunc, then correct using the exact remainder s - trunc(s).
+ */
+static inline int32_t q_round_i32(float32_t s, q_round_t mode, uint32_t ctr)
+{
+    int32_t   i = (int32_t)s;
+    float32_t d = s - (float32_t)i;
+    int32_t   f;
+
+    switch (mode)
+    {
+        case Q_ROUND_NEAREST_EVEN:
+            return i + ((d > 0.5f) || (d == 0.5f && (i & 1))) - ((d < -0.5f) || (d == -0.5f && (i & 1)));
+        case Q_ROUND_HALF_AWAY:
+            return i + (d >= 0.5f) - (d <= -0.5f);
+        case Q_ROUND_FLOOR:
+            return i - (d < 0.0f);
+        case Q_ROUND_STOCHASTIC:
+            f = i - (d < 0.0f);
+            return f + ((float32_t)(q_hash32(ctr) >> 8) * (1.0f / 16777216.0f) < s - (float32_t)f);
+        default:
+            return i;
+    }
+}
+
+
+// Scalar
+
+/** @brief Converts float32 to 8-bit Qn with saturation and given rounding. */
+static inline fix8_t Qx_b08_r(unsigned int N, float32_t x, q_round_t mode, uint32_t ctr)
+{
+    float32_t s = x * (float32_t)SCALE_FACTOR_08(N);
+    s = s > (float32_t)Q_MAXb08 ? (float32_t)Q_MAXb08 : (s < (float32_t)Q_MINb08 ? (float32_t)Q_MINb08 : s);
+    return (fix8_t)q_round_i32(s, mode, ctr);
+}
+
+/** @brief Converts float32 to 16-bit Qn with saturation and given rounding. */
+static inline fix16_t Qx_b16_r(unsigned int N, float32_t x, q_round_t mode, uint32_t ctr)
+{
+    float32_t s = x * (float32_t)SCALE_FACTOR_16(N);
+    s = s > (float32_t)Q_MAXb16 ? (float32_t)Q_MAXb16 : (s < (float32_t)Q_MINb16 ? (float32_t)Q_MINb16 : s);
+    return (fix16_t)q_round_i32(s, mode, ctr);
+}
+
+/** @brief Converts float32 to 32-bit Qn with saturation and given rounding. */
+static inline fix32_t Qx_b32_r(unsigned int N, float32_t x, q_round_t mode, uint32_t ctr)
+{
+    float32_t s = x * (float32_t)SCALE_FACTOR_32(N);
+    if (s >= 2147483648.0f)
+    {
+        return Q_MAXb32;
+    }
+    s = s < -2147483648.0f ? -2147483648.0f : s;
+    return (fix32_t)q_round_i32(s, mode, ctr);
+}
+
+/** @brief Converts float32 to 64-bit Qn with saturation and given rounding.
+ *  @note  Floats of magnitude 2^23 and up are integers, only smaller ones need rounding. */
+static inline fix64_t Qx_b64_r(unsigned int N, float32_t x, q_round_t mode, uint32_t ctr)
+{
+    float32_t s = x * (float32_t)SCALE_FACTOR_64(N);
+    if (s > -2147483648.0f && s < 2147483648.0f)
+    {
+        return (fix64_t)q_round_i32(s, mode, ctr);
+    }
+    return Qx_b64(N, x);
+}
+
+
+// Plain C kernels
+
+/** @brief Converts n float32 values to 8-bit Qn with Qx_b08_r(). @note RARELY USE DIRECTLY. */
+static inline void q_f32_to_b08_r_c(unsigned int N, fix8_t *dst, const float32_t *src, size_t n, q_round_t mode, uint32_t ctr)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        dst[i] = Qx_b08_r(N, src[i], mode, ctr + (uint32_t)i);
+    }
+}
+
+/** @brief Converts n float32 values to 16-bit Qn with Qx_b16_r(). @note RARELY USE DIRECTLY. */
+static inline void q_f32_to_b16_r_c(unsigned int N, fix16_t *dst, const float32_t *src, size_t n, q_round_t mode, uint32_t ctr)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        dst[i] = Qx_b16_r(N, src[i], mode, ctr + (uint32_t)i);
+    }
+}
+
+/** @brief Converts n float32 values to 32-bit Qn with Qx_b32_r(). @note RARELY USE DIRECTLY. */
+static inline void q_f32_to_b32_r_c(unsigned int N, fix32_t *dst, const float32_t *src, size_t n, q_round_t mode, uint32_t ctr)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        dst[i] = Qx_b32_r(N, src[i], mode, ctr + (uint32_t)i);
+    }
+}
+
+/** @brief Converts n float32 values to 64-bit Qn with Qx_b64_r(). @note RARELY USE DIRECTLY. */
+static inline void q_f32_to_b64_r_c(unsigned int N, fix64_t *dst, const float32_t *src, size_t n, q_round_t mode, uint32_t ctr)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        dst[i] = Qx_b64_r(N, src[i], mode, ctr + (uint32_t)i);
+    }
+}
+
+
+/*
+ * SIMD kernels: clamp in float (the limits are integers, so clamp and round commute),
+ * then round with the same trunc-and-correct steps as q_round_i32(). Compare masks
+ * are all ones, so adding a mask subtracts one.
+ */
+
+#if Q_SIMD_SSE2
+Q_TARGET_SSE2_BEGIN
+
+/** @brief 32-bit multiply, low half. SSE2 has only the 32x32->64 pmuludq. */
+static inline __m128i q_mullo_epi32_sse2(__m128i a, __m128i b)
+{
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd  = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd,  _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+/** @brief q_hash32() on 4 lanes. */
+static inline __m128i q_hash32_sse2(__m128i x)
+{
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+    x = q_mullo_epi32_sse2(x, _mm_set1_epi32(0x7FEB352D));
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 15));
+    x = q_mullo_epi32_sse2(x, _mm_set1_epi32((int)0x846CA68BU));
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+    return x;
+}
+
+/** @brief q_round_i32() on 4 lanes, c holds the per-lane counters. */
+static inline __m128i q_round_epi32_sse2(__m128 s, q_round_t mode, __m128i c)
+{
+    __m128i i, f;
+    __m128  d, u;
+
+    switch (mode)
+    {
+        case Q_ROUND_NEAREST_EVEN:
+            return _mm_cvtps_epi32(s);
+        case Q_ROUND_HALF_AWAY:
+            i = _mm_cvttps_epi32(s);
+            d = _mm_sub_ps(s, _mm_cvtepi32_ps(i));
+            i = _mm_sub_epi32(i, _mm_castps_si128(_mm_cmpge_ps(d, _mm_set1_ps( 0.5f))));
+            return _mm_add_epi32(i, _mm_castps_si128(_mm_cmple_ps(d, _mm_set1_ps(-0.5f))));
+        case Q_ROUND_FLOOR:
+            i = _mm_cvttps_epi32(s);
+            return _mm_add_epi32(i, _mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(i), s)));
+        case Q_ROUND_STOCHASTIC:
+            i = _mm_cvttps_epi32(s);
+            f = _mm_add_epi32(i, _mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(i), s)));
+            d = _mm_sub_ps(s, _mm_cvtepi32_ps(f));
+            u = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(q_hash32_sse2(c), 8)), _mm_set1_ps((1.0f / 16777216.0f)));
+            return _mm_sub_epi32(f, _mm_castps_si128(_mm_cmplt_ps(u, d)));
+        default:
+            return _mm_cvttps_epi32(s);
+    }
+}
+
+static inline void q_f32_to_b08_r_sse2(unsigned int N, fix8_t *dst, const float32_t *src, size_t n, q_round_t mode, uint32_t ctr)
+{
+    const __m128  scale = _mm_set1_ps((float32_t)SCALE_FACTOR_08(N));
+    const __m128  hi    = _mm_set1_ps((float32_t)Q_MAXb08);
+    const __m128  lo    = _mm_set1_ps((float32_t)Q_MINb08);
+    const __m128i step  = _mm_set1_epi32(4);
+    __m128i c = _mm_add_epi32(_mm_set1_epi32((int)ctr), _mm_setr_epi32(0, 1, 2, 3));
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i r[4];
+        for (int k = 0; k < 4; k++)
+        {
+            __m128 a = _mm_mul_ps(_mm_loadu_ps(src + i + 4 * k), scale);
+            r[k] = q_round_epi32_sse2(_mm_max_ps(_mm_min_ps(a, hi), lo), mode, c);
+            c = _mm_add_epi32(c, step);
+        }
+        __m128i ab = _mm_packs_epi32(r[0], r[1]);
+        __m128i cd = _mm_packs_epi32(r[2], r[3]);
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_packs_epi16(ab, cd));
+    }
+    q_f32_to_b08_r_c(N, dst + i, src + i, n - i, mode, ctr + (uint32_t)i);
+}
+
+static inline void q_f32_to_b16_r_sse2(unsigned int N, fix16_t *dst, const float32_t *src, size_t n, q_round_t mode, uint32_t ctr)
+{
+    const __m128  scale = _mm_set1_ps((float32_t)SCALE_FACTOR_16(N));
+    const __m128  hi    = _mm_set1_ps((float32_t)Q_MAXb16);
+    const __m128  lo    = _mm_set1_ps((float32_t)Q_MINb16);
+    const __m128i step  = _mm_set1_epi32(4);
+    __m128i c = _mm_add_epi32(_mm_set1_epi32((int)ctr), _mm_setr_epi32(0, 1, 2, 3));
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128 a = _mm_mul_ps(_mm_loadu_ps(src + i    ), scale);
+        __m128 b = _mm_mul_ps(_mm_loadu_ps(src + i + 4), scale);
+        __m128i ra = q_round_epi32_sse2(_mm_max_ps(_mm_min_ps(a, hi), lo), mode, c);
+        c = _mm_add_epi32(c, step);
+        __m128i rb = q_round_epi32_sse2(_mm_max_ps(_mm_min_ps(b, hi), lo), mode, c);
+        c = _mm_add_epi32(c, step);
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_packs_epi32(ra, rb));
+    }
+    q_f32_to_b16_r_c(N, dst + i, src + i, n - i, mode, ctr + (uint32_t)i);
+}
+
+static inline void q_f32_to_b32_r_sse2(unsigned int N, fix32_t *dst, const float32_t *src, size_t n, q_round_t mode, uint32_t ctr)
+{
+    const __m128  scale = _mm_set1_ps((float32_t)SCALE_FACTOR_32(N));
+    const __m128  ovf   = _mm_set1_ps(2147483648.0f);
+    const __m128  hi    = _mm_set1_ps(2147483520.0f);   /* Largest float below 2^31. */
+    const __m128  lo    = _mm_set1_ps(-2147483648.0f);
+    const __m128i qmax  = _mm_set1_epi32(Q_MAXb32);
+    const __m128i step  = _mm_set1_epi32(4);
+    __m128i c = _mm_add_epi32(_mm_set1_epi32((int)ctr), _mm_setr_epi32(0, 1, 2, 3));
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128  a = _mm_mul_ps(_mm_loadu_ps(src + i), scale);
+        __m128i m = _mm_castps_si128(_mm_cmpge_ps(a, ovf));
+        __m128i r = q_round_epi32_sse2(_mm_max_ps(_mm_min_ps(a, hi), lo), mode, c);
+        c = _mm_add_epi32(c, step);
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_or_si128(_mm_andnot_si128(m, r), _mm_and_si128(m, qmax)));
+    }
+    q_f32_to_b32_r_c(N, dst + i, src + i, n - i, mode, ctr + (uint32_t)i);
+}
+
+Q_TARGET_END
+#endif /* Q_SIMD_SSE2 */
+
+
+#if Q_SIMD_AVX2
+Q_TARGET_AVX2_BEGIN
+
+/** @brief q_hash32() on 8 lanes. */
+static inline __m256i q_hash32_avx2(__m256i x)
+{
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+    x = _mm256_mullo_epi32(x, _mm256_set1_epi32(0x7FEB352D));
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 15));
+    x = _mm256_mullo_epi32(x, _mm256_set1_epi32((int)0x846CA68BU));
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+    return x;
+}
+
+/** @brief q_round_i32() on 8 lanes, c holds the per-lane counters. */
+static inline __m256i q_round_epi32_avx2(__m256 s, q_round_t mode, __m256i c)
+{
+    __m256i i, f;
+    __m256  d, u;
+
+    switch (mode)
+    {
+        case Q_ROUND_NEAREST_EVEN:
+            return _mm256_cvtps_epi32(s);
+        case Q_ROUND_HALF_AWAY:
+            i = _mm256_cvttps_epi32(s);
+            d = _mm256_sub_ps(s, _mm256_cvtepi32_ps(i));
+            i = _mm256_sub_epi32(i, _mm256_castps_si256(_mm256_cmp_ps(d, _mm256_set1_ps( 0.5f), _CMP_GE_OQ)));
+            return _mm256_add_epi32(i, _mm256_castps_si256(_mm256_cmp_ps(d, _mm256_set1_ps(-0.5f), _CMP_LE_OQ)));
+        case Q_ROUND_FLOOR:
+            return _mm256_cvttps_epi32(_mm256_round_ps(s, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC));
+        case Q_ROUND_STOCHASTIC:
+            d = _mm256_round_ps(s, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+            f = _mm256_cvttps_epi32(d);
+            d = _mm256_sub_ps(s, d);
+            u = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(q_hash32_avx2(c), 8)), _mm256_set1_ps((1.0f / 16777216.0f)));
+            return _mm256_sub_epi32(f, _mm256_castps_si256(_mm256_cmp_ps(u, d, _CMP_LT_OQ)));
+        default:
+            return _mm256_cvttps_epi32(s);
+    }
+}
+
+static inline void q_f32_to_b08_r_avx2(unsigned int N, fix8_t *dst, const float32_t *src, size_t n, q_round_t mode, uint32_t ctr)
+{
+    const __m256  scale = _mm256_set1_ps((float32_t)SCALE_FACTOR_08(N));
+    const __m256  hi    = _mm256_set1_ps((float32_t)Q_MAXb08);
+    const __m256  lo    = _mm256_set1_ps((float32_t)Q_MINb08);
+    const __m256i perm  = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    const __m256i step  = _mm256_set1_epi32(8);
+    __m256i c = _mm256_add_epi32(_mm256_set1_epi32((int)ctr), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    size_t i = 0;
+
+    for (; i + 32 <= n; i += 32)
+    {
+        __m256i r[4];
+        for (int k = 0; k < 4; k++)
+        {
+            __m256 a = _mm256_mul_ps(_mm256_loadu_ps(src + i + 8 * k), scale);
+            r[k] = q_round_epi32_avx2(_mm256_max_ps(_mm256_min_ps(a, hi), lo), mode, c);
+            c = _mm256_add_epi32(c, step);
+        }
+        __m256i ab = _mm256_packs_epi32(r[0], r[1]);
+        __m256i cd = _mm256_packs_epi32(r[2], r[3]);
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_permutevar8x32_epi32(_mm256_packs_epi16(ab, cd), perm));
+    }
+    q_f32_to_b08_r_c(N, dst + i, src + i, n - i, mode, ctr + (uint32_t)i);
+}
+
+static inline void q_f32_to_b16_r_avx2(unsigned int N, fix16_t *dst, const float32_t *src, size_t n, q_round_t mode, uint32_t ctr)
+{
+    const __m256  scale = _mm256_set1_ps((float32_t)SCALE_FACTOR_16(N));
+    const __m256  hi    = _mm256_set1_ps((float32_t)Q_MAXb16);
+    const __m256  lo    = _mm256_set1_ps((float32_t)Q_MINb16);
+    const __m256i step  = _mm256_set1_epi32(8);
+    __m256i c = _mm256_add_epi32(_mm256_set1_epi32((int)ctr), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m256 a = _mm256_mul_ps(_mm256_loadu_ps(src + i    ), scale);
+        __m256 b = _mm256_mul_ps(_mm256_loadu_ps(src + i + 8), scale);
+        __m256i ra = q_round_epi32_avx2(_mm256_max_ps(_mm256_min_ps(a, hi), lo), mode, c);
+        c = _mm256_add_epi32(c, step);
+        __m256i rb = q_round_epi32_avx2(_mm256_max_ps(_mm256_min_ps(b, hi), lo), mode, c);
+        c = _mm256_add_epi32(c, step);
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_permute4x64_epi64(_mm256_packs_epi32(ra, rb), 0xD8));
+    }
+    q_f32_to_b16_r_c(N, dst + i, src + i, n - i, mode, ctr + (uint32_t)i);
+}
+
+static inline void q_f32_to_b32_r_avx2(unsigned int N, fix32_t *dst, const float32_t *src, size_t n, q_round_t mode, uint32_t ctr)
+{
+    const __m256  scale = _mm256_set1_ps((float32_t)SCALE_FACTOR_32(N));
+    const __m256  ovf   = _mm256_set1_ps(2147483648.0f);
+    const __m256  hi    = _mm256_set1_ps(2147483520.0f);
+    const __m256  lo    = _mm256_set1_ps(-2147483648.0f);
+    const __m256i qmax  = _mm256_set1_epi32(Q_MAXb32);
+    const __m256i step  = _mm256_set1_epi32(8);
+    __m256i c = _mm256_add_epi32(_mm256_set1_epi32((int)ctr), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256  a = _mm256_mul_ps(_mm256_loadu_ps(src + i), scale);
+        __m256i m = _mm256_castps_si256(_mm256_cmp_ps(a, ovf, _CMP_GE_OQ));
+        __m256i r = q_round_epi32_avx2(_mm256_max_ps(_mm256_min_ps(a, hi), lo), mode, c);
+        c = _mm256_add_epi32(c, step);
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_blendv_epi8(r, qmax, m));
+    }
+    q_f32_to_b32_r_c(N, dst + i, src + i, n - i, mode, ctr + (uint32_t)i);
+}
+
+Q_TARGET_END
+#endif /* Q_SIMD_AVX2 */
+
+
+#if Q_SIMD_AVX512
+Q_TARGET_AVX512_BEGIN
+
+/** @brief q_hash32() on 16 lanes. */
+static inline __m512i q_hash32_avx512(__m512i x)
+{
+    x = _mm512_xor_si512(x, _mm512_srli_epi32(x, 16));
+    x = _mm512_mullo_epi32(x, _mm512_set1_epi32(0x7FEB352D));
+    x = _mm512_xor_si512(x, _mm512_srli_epi32(x, 15));
+    x = _mm512_mullo_epi32(x, _mm512_set1_epi32((int)0x846CA68BU));
+    x = _mm512_xor_si512(x, _mm512_srli_epi32(x, 16));
+    return x;
+}
+
+/** @brief q_round_i32() on 16 lanes, rounding done inside the conversion where possible. */
+static inline __m512i q_round_epi32_avx512(__m512 s, q_round_t mode, __m512i c)
+{
+    const __m512i one = _mm512_set1_epi32(1);
+    __m512i i, f;
+    __m512  d, u;
+
+    switch (mode)
+    {
+        case Q_ROUND_NEAREST_EVEN:
+            return _mm512_cvt_roundps_epi32(s, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        case Q_ROUND_HALF_AWAY:
+            i = _mm512_cvttps_epi32(s);
+            d = _mm512_sub_ps(s, _mm512_cvtepi32_ps(i));
+            i = _mm512_mask_add_epi32(i, _mm512_cmp_ps_mask(d, _mm512_set1_ps( 0.5f), _CMP_GE_OQ), i, one);
+            return _mm512_mask_sub_epi32(i, _mm512_cmp_ps_mask(d, _mm512_set1_ps(-0.5f), _CMP_LE_OQ), i, one);
+        case Q_ROUND_FLOOR:
+            return _mm512_cvt_roundps_epi32(s, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+        case Q_ROUND_STOCHASTIC:
+            f = _mm512_cvt_roundps_epi32(s, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+            d = _mm512_sub_ps(s, _mm512_cvtepi32_ps(f));
+            u = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_srli_epi32(q_hash32_avx512(c), 8)), _mm512_set1_ps((1.0f / 16777216.0f)));
+            return _mm512_mask_add_epi32(f, _mm512_cmp_ps_mask(u, d, _CMP_LT_OQ), f, one);
+        default:
+            return _mm512_cvttps_epi32(s);
+    }
+}
+
+static inline void q_f32_to_b08_r_avx512(unsigned int N, fix8_t *dst, const float32_t *src, size_t n, q_round_t mode, uint32_t ctr)
+{
+    const __m512  scale = _mm512_set1_ps((float32_t)SCALE_FACTOR_08(N));
+    const __m512  hi    = _mm512_set1_ps((float32_t)Q_MAXb08);
+    const __m512  lo    = _mm512_set1_ps((float32_t)Q_MINb08);
+    const __m512i step  = _mm512_set1_epi32(16);
+    __m512i c = _mm512_add_epi32(_mm512_set1_epi32((int)ctr), _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m512  a = _mm512_mul_ps(_mm512_loadu_ps(src + i), scale);
+        __m512i r = q_round_epi32_avx512(_mm512_max_ps(_mm512_min_ps(a, hi), lo), mode, c);
+        c = _mm512_add_epi32(c, step);
+        _mm_storeu_si128((__m128i *)(dst + i), _mm512_cvtepi32_epi8(r));
+    }
+    q_f32_to_b08_r_c(N, dst + i, src + i, n - i, mode, ctr + (uint32_t)i);
+}
+
+static inline void q_f32_to_b16_r_avx512(unsigned int N, fix16_t *dst, const float32_t *src, size_t n, q_round_t mode, uint32_t ctr)
+{
+    const __m512  scale = _mm512_set1_ps((float32_t)SCALE_FACTOR_16(N));
+    const __m512  hi    = _mm512_set1_ps((float32_t)Q_MAXb16);
+    const __m512  lo    = _mm512_set1_ps((float32_t)Q_MINb16);
+    const __m512i step  = _mm512_set1_epi32(16);
+    __m512i c = _mm512_add_epi32(_mm512_set1_epi32((int)ctr), _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m512  a = _mm512_mul_ps(_mm512_loadu_ps(src + i), scale);
+        __m512i r = q_round_epi32_avx512(_mm512_max_ps(_mm512_min_ps(a, hi), lo), mode, c);
+        c = _mm512_add_epi32(c, step);
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm512_cvtepi32_epi16(r));
+    }
+    q_f32_to_b16_r_c(N, dst + i, src + i, n - i, mode, ctr + (uint32_t)i);
+}
+
+static inline void q_f32_to_b32_r_avx512(unsigned int N, fix32_t *dst, const float32_t *src, size_t n, q_round_t mode, uint32_t ctr)
+{
+    const __m512  scale = _mm512_set1_ps((float32_t)SCALE_FACTOR_32(N));
+    const __m512  ovf   = _mm512_set1_ps(2147483648.0f);
+    const __m512  hi    = _mm512_set1_ps(2147483520.0f);
+    const __m512  lo    = _mm512_set1_ps(-2147483648.0f);
+    const __m512i qmax  = _mm512_set1_epi32(Q_MAXb32);
+    const __m512i step  = _mm512_set1_epi32(16);
+    __m512i c = _mm512_add_epi32(_mm512_set1_epi32((int)ctr), _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m512    a = _mm512_mul_ps(_mm512_loadu_ps(src + i), scale);
+        __mmask16 m = _mm512_cmp_ps_mask(a, ovf, _CMP_GE_OQ);
+        __m512i   r = q_round_epi32_avx512(_mm512_max_ps(_mm512_min_ps(a, hi), lo), mode, c);
+        c = _mm512_add_epi32(c, step);
+        _mm512_storeu_si512((void *)(dst + i), _mm512_mask_mov_epi32(r, m, qmax));
+    }
+    q_f32_to_b32_r_c(N, dst + i, src + i, n - i, mode, ctr + (uint32_t)i);
+}
+
+Q_TARGET_END
+#endif /* Q_SIMD_AVX512 */
+
+
+// Kernel table, bound once per translation unit to the tier from q_isa().
+
+typedef struct
+{
+    void (*f32_to_b08)(unsigned int N, fix8_t  *dst, const float32_t *src, size_t n, q_round_t mode, uint32_t ctr);
+    void (*f32_to_b16)(unsigned int N, fix16_t *dst, const float32_t *src, size_t n, q_round_t mode, uint32_t ctr);
+    void (*f32_to_b32)(unsigned int N, fix32_t *dst, const float32_t *src, size_t n, q_round_t mode, uint32_t ctr);
+    void (*f32_to_b64)(unsigned int N, fix64_t *dst, const float32_t *src, size_t n, q_round_t mode, uint32_t ctr);
+    int    bound;
+} q_round_fn_t;
+
+static q_round_fn_t q_round_k;
+
+#ifdef Q_SAT_COUNT
+static q_round_fn_t q_round_raw;    /* Kernels behind the counting wrappers, see q_sat.h. */
+
+#define Q_ROUND_SAT(W, T)                                                                   \
+    static inline void q_f32_to_b##W##_r_sat(unsigned int N, T *dst, const float32_t *src,  \
+                                             size_t n, q_round_t mode, uint32_t ctr)        \
+    {                                                                                       \
+        for (size_t i = 0; i < n; i += Q_SAT_BLOCK)                                         \
+        {                                                                                   \
+            size_t m = n - i < Q_SAT_BLOCK ? n - i : Q_SAT_BLOCK;                           \
+            q_sat_f32(sizeof(T) * 8U, N, src + i, m);                                       \
+            q_round_raw.f32_to_b##W(N, dst + i, src + i, m, mode, ctr + (uint32_t)i);       \
+        }                                                                                   \
+    }
+
+Q_ROUND_SAT(08, fix8_t)
+Q_ROUND_SAT(16, fix16_t)
+Q_ROUND_SAT(32, fix32_t)
+Q_ROUND_SAT(64, fix64_t)
+#endif
+
+/** @brief Fills q_round_k for q_isa(). Runs before main() where supported. @note RARELY USE DIRECTLY. */
+static Q_CONSTRUCTOR void q_round_bind(void)
+{
+    q_isa_t      isa = q_isa();
+    q_round_fn_t k   = { q_f32_to_b08_r_c, q_f32_to_b16_r_c, q_f32_to_b32_r_c, q_f32_to_b64_r_c, 1 };
+
+    (void)isa;
+#if Q_SIMD_SSE2
+    if (isa >= Q_ISA_SSE2)
+    {
+        k.f32_to_b08 = q_f32_to_b08_r_sse2;
+        k.f32_to_b16 = q_f32_to_b16_r_sse2;
+        k.f32_to_b32 = q_f32_to_b32_r_sse2;
+    }
+#endif
+#if Q_SIMD_AVX2
+    if (isa >= Q_ISA_AVX2)
+    {
+        k.f32_to_b08 = q_f32_to_b08_r_avx2;
+        k.f32_to_b16 = q_f32_to_b16_r_avx2;
+        k.f32_to_b32 = q_f32_to_b32_r_avx2;
+    }
+#endif
+#if Q_SIMD_AVX512
+    if (isa >= Q_ISA_AVX512)
+    {
+        k.f32_to_b08 = q_f32_to_b08_r_avx512;
+        k.f32_to_b16 = q_f32_to_b16_r_avx512;
+        k.f32_to_b32 = q_f32_to_b32_r_avx512;
+    }
+#endif
+#ifdef Q_SAT_COUNT
+    q_round_raw  = k;
+    k.f32_to_b08 = q_f32_to_b08_r_sat;
+    k.f32_to_b16 = q_f32_to_b16_r_sat;
+    k.f32_to_b32 = q_f32_to_b32_r_sat;
+    k.f32_to_b64 = q_f32_to_b64_r_sat;
+#endif
+    q_round_k = k;
+}
+
+/** @brief Bound kernel table. Binds on first use if the constructor has not run yet. @note RARELY USE DIRECTLY. */
+static inline const q_round_fn_t *q_round_fn(void)
+{
+    if (!q_round_k.bound)
+    {
+        q_round_bind();
+    }
+    return &q_round_k;
+}
+
+
+// Use this!
+
+/** @brief Converts n float32 values to 8-bit Qn, same as Qx_b08_r(N, src[i], mode, ctr + i). */
+static inline void Qx_b08_array_r(unsigned int N, fix8_t *dst, const float32_t *src, size_t n, q_round_t mode, uint32_t ctr)
+{
+    q_round_fn()->f32_to_b08(N, dst, src, n, mode, ctr);
+}
+
+/** @brief Converts n float32 values to 16-bit Qn, same as Qx_b16_r(N, src[i], mode, ctr + i). */
+static inline void Qx_b16_array_r(unsigned int N, fix16_t *dst, const float32_t *src, size_t n, q_round_t mode, uint32_t ctr)
+{
+    q_round_fn()->f32_to_b16(N, dst, src, n, mode, ctr);
+}
+
+/** @brief Converts n float32 values to 32-bit Qn, same as Qx_b32_r(N, src[i], mode, ctr + i). */
+static inline void Qx_b32_array_r(unsigned int N, fix32_t *dst, const float32_t *src, size_t n, q_round_t mode, uint32_t ctr)
+{
+    q_round_fn()->f32_to_b32(N, dst, src, n, mode, ctr);
+}
+
+/** @brief Converts n float32 values to 64-bit Qn, same as Qx_b64_r(N, src[i], mode, ctr + i).
+ *  @note  Not vectorized. */
+static inline void Qx_b64_array_r(unsigned int N, fix64_t *dst, const float32_t *src, size_t n, q_round_t mode, uint32_t ctr)
+{
+    q_round_fn()->f32_to_b64(N, dst, src, n, mode, ctr);
+}
+
+// Most used formats, round to nearest even.
+#define Q7_b8_rne(x)    Qx_b08_r( 7, x, Q_ROUND_NEAREST_EVEN, 0U)  /**< Converts float to 8-bit Q7, round to nearest even. */
+#define Q15_b16_rne(x)  Qx_b16_r(15, x, Q_ROUND_NEAREST_EVEN, 0U)  /**< Converts float to 16-bit Q15, round to nearest even. */
+#define Q31_b32_rne(x)  Qx_b32_r(31, x, Q_ROUND_NEAREST_EVEN, 0U)  /**< Converts float to 32-bit Q31, round to nearest even. */
+
+
+#endif /* SRC_Q_ROUND_H_ */
@@ -0,0 +1,399 @@
+/**
+ * @file    q_sat.h
+ * @brief   Saturation counters for the array conversions, opt-in at compile
+ *          time.
+ *
+ *          Build with -DQ_SAT_COUNT and every float-to-fixed array call
+ *          (Qx_bxx_array(), Qx_bxx_array_d(), Qx_bxx_array_r() and the _mt
+ *          forms) counts its inputs at or above F_MAXbxx(N) (positive clip)
+ *          and below F_MINbxx(N) (negative clip), per word size and N.
+ *
+ *          Each thread counts into its own block, looked up through a
+ *          thread-local pointer; q_sat_get() adds up all threads, including
+ *          ones that have exited. The array functions count Q_SAT_BLOCK
+ *          elements right before converting them, so the input is read from
+ *          L1 the second time; the SIMD count kernels compare and popcount
+ *          the masks, no per-element branches.
+ *
+ *          Without Q_SAT_COUNT nothing is counted, the conversion code is the
+ *          same as before, and q_sat_get() returns zeros, so calls to it can
+ *          stay in the code.
+ *
+ *          @code
+ *          Q15_b16_array(out, in, n);
+ *          q_sat_count_t c = q_sat_get(16, 15);   // c.pos, c.neg
+ *          q_sat_fprint(stderr);                  // every format with clips
+ *          @endcode
+ *
+ * @note    Counting needs GCC or Clang and POSIX threads (-pthread).
+ * @note    The scalar macros are not counted, they stay constant expressions.
+ * @note    Qx_bxx_array_r() counts the same range as Qx_bxx(); inputs within
+ *          half a step below F_MAXbxx(N) that round up to Q_MAXbxx are not
+ *          counted.
+ */
+
+#ifndef SRC_Q_SAT_H_
+#define SRC_Q_SAT_H_
+
+
+#include "q_macros.h"
+#include "q_simd.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/** @brief Clips of one format. */
+typedef struct
+{
+    uint64_t pos;   /**< Inputs at or above F_MAXbxx(N). */
+    uint64_t neg;   /**< Inputs below F_MINbxx(N). */
+} q_sat_count_t;
+
+
+#ifdef Q_SAT_COUNT
+
+#if !defined(__GNUC__) && !defined(__clang__)
+#error "Q_SAT_COUNT needs GCC or Clang (thread-local and weak symbols)"
+#endif
+
+#include <pthread.h>
+#include <stdlib.h>
+
+#ifndef Q_SAT_BLOCK
+#define Q_SAT_BLOCK     2048U       /**< Elements counted and converted at a time. */
+#endif
+
+/** @brief Counters of one thread, indexed [word: 8, 16, 32, 64][N]. */
+typedef struct q_sat_block
+{
+    uint64_t            pos[4][64];
+    uint64_t            neg[4][64];
+    struct q_sat_block *next;
+} q_sat_block_t;
+
+/** @brief All threads' blocks. One instance per program (weak). */
+typedef struct
+{
+    pthread_mutex_t lock;
+    pthread_key_t   key;            /**< Destructor folds an exiting thread into gone. */
+    q_sat_block_t  *live;
+    q_sat_block_t   gone;
+} q_sat_reg_t;
+
+__attribute__((weak)) pthread_once_t          q_sat_once = PTHREAD_ONCE_INIT;
+__attribute__((weak)) q_sat_reg_t             q_sat_reg;
+__attribute__((weak)) __thread q_sat_block_t *q_sat_mine;
+
+
+/** @brief Word size to counter row. @note RARELY USE DIRECTLY. */
+static inline unsigned int q_sat_row(unsigned int bits)
+{
+    return bits == 8 ? 0U : bits == 16 ? 1U : bits == 32 ? 2U : 3U;
+}
+
+/** @brief Thread exit: adds the block to the totals and frees it. @note RARELY USE DIRECTLY. */
+static inline void q_sat_exit(void *arg)
+{
+    q_sat_block_t  *b = (q_sat_block_t *)arg;
+    q_sat_block_t **p;
+
+    pthread_mutex_lock(&q_sat_reg.lock);
+    for (p = &q_sat_reg.live; *p != NULL && *p != b; p = &(*p)->next)
+    {
+    }
+    if (*p == b)
+    {
+        *p = b->next;
+    }
+    for (unsigned int r = 0; r < 4; r++)
+    {
+        for (unsigned int n = 0; n < 64; n++)
+        {
+            q_sat_reg.gone.pos[r][n] += __atomic_load_n(&b->pos[r][n], __ATOMIC_RELAXED);
+            q_sat_reg.gone.neg[r][n] += __atomic_load_n(&b->neg[r][n], __ATOMIC_RELAXED);
+        }
+    }
+    pthread_mutex_unlock(&q_sat_reg.lock);
+    free(b);
+}
+
+/** @brief One-time setup of the registry. @note RARELY USE DIRECTLY. */
+static inline void q_sat_setup(void)
+{
+    pthread_mutex_init(&q_sat_reg.lock, NULL);
+    pthread_key_create(&q_sat_reg.key, q_sat_exit);
+}
+
+/** @brief Block of the calling thread, created on first use. NULL if out of memory. @note RARELY USE DIRECTLY. */
+static inline q_sat_block_t *q_sat_block(void)
+{
+    q_sat_block_t *b = q_sat_mine;
+
+    if (b == NULL)
+    {
+        pthread_once(&q_sat_once, q_sat_setup);
+        b = (q_sat_block_t *)calloc(1, sizeof(q_sat_block_t));
+        if (b == NULL)
+        {
+            return NULL;
+        }
+        pthread_mutex_lock(&q_sat_reg.lock);
+        b->next        = q_sat_reg.live;
+        q_sat_reg.live = b;
+        pthread_mutex_unlock(&q_sat_reg.lock);
+        pthread_setspecific(q_sat_reg.key, b);
+        q_sat_mine = b;
+    }
+    return b;
+}
+
+/** @brief Adds pos/neg clips of a bits-wide Qn format to this thread. @note RARELY USE DIRECTLY. */
+static inline void q_sat_add(unsigned int bits, unsigned int N, uint64_t pos, uint64_t neg)
+{
+    q_sat_block_t *b = (pos | neg) != 0 ? q_sat_block() : NULL;
+
+    if (b != NULL)
+    {
+        __atomic_fetch_add(&b->pos[q_sat_row(bits)][N & 63U], pos, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&b->neg[q_sat_row(bits)][N & 63U], neg, __ATOMIC_RELAXED);
+    }
+}
+
+
+// Count kernels: c[0] += x >= hi, c[1] += x < lo.
+
+static inline void q_sat_f32_c(const float32_t *x, size_t n, float32_t hi, float32_t lo, uint64_t c[2])
+{
+    uint64_t p = 0, q = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        p += x[i] >= hi;
+        q += x[i] <  lo;
+    }
+    c[0] += p;
+    c[1] += q;
+}
+
+static inline void q_sat_f64_c(const float64_t *x, size_t n, float64_t hi, float64_t lo, uint64_t c[2])
+{
+    uint64_t p = 0, q = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        p += x[i] >= hi;
+        q += x[i] <  lo;
+    }
+    c[0] += p;
+    c[1] += q;
+}
+
+#if Q_SIMD_SSE2
+Q_TARGET_SSE2_BEGIN
+
+/* No popcnt in the SSE2 tier: compare masks are -1, subtract them into lane counters.
+   Lanes are 32 bit, fine for Q_SAT_BLOCK sized calls. */
+static inline void q_sat_f32_sse2(const float32_t *x, size_t n, float32_t hi, float32_t lo, uint64_t c[2])
+{
+    const __m128 h  = _mm_set1_ps(hi);
+    const __m128 l  = _mm_set1_ps(lo);
+    __m128i      cp = _mm_setzero_si128();
+    __m128i      cn = _mm_setzero_si128();
+    uint32_t     t[4];
+    size_t       i  = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 v = _mm_loadu_ps(x + i);
+        cp = _mm_sub_epi32(cp, _mm_castps_si128(_mm_cmpge_ps(v, h)));
+        cn = _mm_sub_epi32(cn, _mm_castps_si128(_mm_cmplt_ps(v, l)));
+    }
+    _mm_storeu_si128((__m128i *)t, cp);
+    c[0] += (uint64_t)t[0] + t[1] + t[2] + t[3];
+    _mm_storeu_si128((__m128i *)t, cn);
+    c[1] += (uint64_t)t[0] + t[1] + t[2] + t[3];
+    q_sat_f32_c(x + i, n - i, hi, lo, c);
+}
+
+Q_TARGET_END
+#endif /* Q_SIMD_SSE2 */
+
+
+#if Q_SIMD_AVX2
+Q_TARGET_AVX2_BEGIN
+
+static inline void q_sat_f32_avx2(const float32_t *x, size_t n, float32_t hi, float32_t lo, uint64_t c[2])
+{
+    const __m256 h = _mm256_set1_ps(hi);
+    const __m256 l = _mm256_set1_ps(lo);
+    uint64_t     p = 0, q = 0;
+    size_t       i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256 v = _mm256_loadu_ps(x + i);
+        p += (uint64_t)__builtin_popcount((unsigned int)_mm256_movemask_ps(_mm256_cmp_ps(v, h, _CMP_GE_OQ)));
+        q += (uint64_t)__builtin_popcount((unsigned int)_mm256_movemask_ps(_mm256_cmp_ps(v, l, _CMP_LT_OQ)));
+    }
+    c[0] += p;
+    c[1] += q;
+    q_sat_f32_c(x + i, n - i, hi, lo, c);
+}
+
+Q_TARGET_END
+#endif /* Q_SIMD_AVX2 */
+
+
+#if Q_SIMD_AVX512
+Q_TARGET_AVX512_BEGIN
+
+static inline void q_sat_f32_avx512(const float32_t *x, size_t n, float32_t hi, float32_t lo, uint64_t c[2])
+{
+    const __m512 h = _mm512_set1_ps(hi);
+    const __m512 l = _mm512_set1_ps(lo);
+    uint64_t     p = 0, q = 0;
+    size_t       i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m512 v = _mm512_loadu_ps(x + i);
+        p += (uint64_t)__builtin_popcount((unsigned int)_mm512_cmp_ps_mask(v, h, _CMP_GE_OQ));
+        q += (uint64_t)__builtin_popcount((unsigned int)_mm512_cmp_ps_mask(v, l, _CMP_LT_OQ));
+    }
+    c[0] += p;
+    c[1] += q;
+    q_sat_f32_c(x + i, n - i, hi, lo, c);
+}
+
+Q_TARGET_END
+#endif /* Q_SIMD_AVX512 */
+
+
+/** @brief Counts clips of n float32 inputs to a bits-wide Qn. @note RARELY USE DIRECTLY. */
+static inline void q_sat_f32(unsigned int bits, unsigned int N, const float32_t *x, size_t n)
+{
+    const float32_t hi   = (float32_t)(1ULL << (bits - 1U - N));
+    uint64_t        c[2] = { 0, 0 };
+
+    switch (q_isa())
+    {
+#if Q_SIMD_AVX512
+        case Q_ISA_AVX512:  q_sat_f32_avx512(x, n, hi, -hi, c); break;
+#endif
+#if Q_SIMD_AVX2
+        case Q_ISA_AVX2:    q_sat_f32_avx2(x, n, hi, -hi, c);   break;
+#endif
+#if Q_SIMD_SSE2
+        case Q_ISA_SSE41:
+        case Q_ISA_SSE2:    q_sat_f32_sse2(x, n, hi, -hi, c);   break;
+#endif
+        default:            q_sat_f32_c(x, n, hi, -hi, c);      break;
+    }
+    q_sat_add(bits, N, c[0], c[1]);
+}
+
+/** @brief Counts clips of n float64 inputs to a bits-wide Qn. @note RARELY USE DIRECTLY. */
+static inline void q_sat_f64(unsigned int bits, unsigned int N, const float64_t *x, size_t n)
+{
+    const float64_t hi   = (float64_t)(1ULL << (bits - 1U - N));
+    uint64_t        c[2] = { 0, 0 };
+
+    q_sat_f64_c(x, n, hi, -hi, c);
+    q_sat_add(bits, N, c[0], c[1]);
+}
+
+/**
+ * @brief Wraps a kernel so each Q_SAT_BLOCK of the input is counted, then converted
+ *        while still in cache. RAW is the kernel table entry to forward to.
+ *        @note RARELY USE DIRECTLY.
+ */
+#define Q_SAT_WRAP(NAME, BITS, DT, ST, COUNT, RAW)                                          \
+    static inline void NAME(unsigned int N, DT *dst, const ST *src, size_t n)               \
+    {                                                                                       \
+        for (size_t i = 0; i < n; i += Q_SAT_BLOCK)                                         \
+        {                                                                                   \
+            size_t m = n - i < Q_SAT_BLOCK ? n - i : Q_SAT_BLOCK;                           \
+            COUNT(BITS, N, src + i, m);                                                     \
+            RAW(N, dst + i, src + i, m);                                                    \
+        }                                                                                   \
+    }
+
+
+// Use this!
+
+/** @brief Clips of the bits-wide (8, 16, 32, 64) Qn format, summed over all threads. */
+static inline q_sat_count_t q_sat_get(unsigned int bits, unsigned int N)
+{
+    q_sat_count_t c = { 0, 0 };
+    unsigned int  r = q_sat_row(bits);
+
+    pthread_once(&q_sat_once, q_sat_setup);
+    pthread_mutex_lock(&q_sat_reg.lock);
+    c.pos = q_sat_reg.gone.pos[r][N & 63U];
+    c.neg = q_sat_reg.gone.neg[r][N & 63U];
+    for (const q_sat_block_t *b = q_sat_reg.live; b != NULL; b = b->next)
+    {
+        c.pos += __atomic_load_n(&b->pos[r][N & 63U], __ATOMIC_RELAXED);
+        c.neg += __atomic_load_n(&b->neg[r][N & 63U], __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&q_sat_reg.lock);
+    return c;
+}
+
+/** @brief Zeroes all counters of all threads. */
+static inline void q_sat_reset(void)
+{
+    pthread_once(&q_sat_once, q_sat_setup);
+    pthread_mutex_lock(&q_sat_reg.lock);
+    for (unsigned int r = 0; r < 4; r++)
+    {
+        for (unsigned int n = 0; n < 64; n++)
+        {
+            q_sat_reg.gone.pos[r][n] = 0;
+            q_sat_reg.gone.neg[r][n] = 0;
+            for (q_sat_block_t *b = q_sat_reg.live; b != NULL; b = b->next)
+            {
+                __atomic_store_n(&b->pos[r][n], 0, __ATOMIC_RELAXED);
+                __atomic_store_n(&b->neg[r][n], 0, __ATOMIC_RELAXED);
+            }
+        }
+    }
+    pthread_mutex_unlock(&q_sat_reg.lock);
+}
+
+#else /* !Q_SAT_COUNT */
+
+/** @brief Always zero, counting is off. */
+static inline q_sat_count_t q_sat_get(unsigned int bits, unsigned int N)
+{
+    q_sat_count_t c = { 0, 0 };
+    (void)bits;
+    (void)N;
+    return c;
+}
+
+/** @brief Nothing to reset, counting is off. */
+static inline void q_sat_reset(void)
+{
+}
+
+#endif /* Q_SAT_COUNT */
+
+/** @brief Prints one line per format with clips, e.g. "b16 Q15: +12 -3". */
+static inline void q_sat_fprint(FILE *f)
+{
+    static const unsigned int bits[4] = { 8, 16, 32, 64 };
+
+    for (unsigned int r = 0; r < 4; r++)
+    {
+        for (unsigned int n = 1; n < bits[r]; n++)
+        {
+            q_sat_count_t c = q_sat_get(bits[r], n);
+            if (c.pos != 0 || c.neg != 0)
+            {
+                fprintf(f, "b%02u Q%u: +%llu -%llu\n", bits[r], n, (unsigned long long)c.pos, (unsigned long long)c.neg);
+            }
+        }
+    }
+}
+
+
+#endif /* SRC_Q_SAT_H_ */
@@ -0,0 +1,191 @@
+/**
+ * @file    q_simd.h
+ * @brief   Instruction set selection for the array conversion kernels.
+ *
+ *          With GCC or Clang on x86 every SIMD kernel is compiled, each
+ *          section under its own target (Q_TARGET_xxx_BEGIN / Q_TARGET_END),
+ *          whatever -m flags the rest of the program uses. q_isa() checks the
+ *          CPU once and the array headers bind their kernel tables to the
+ *          best tier it supports, so a generic x86-64 build still gets the
+ *          AVX2 and AVX-512 paths on hosts that have them.
+ *
+ *          Other compilers only get the kernels their flags allow
+ *          (-msse2, -mavx2, -mavx512f -mavx512bw -mavx512dq -mavx512vl,
+ *          /arch:...), selection is then fixed at compile time.
+ *
+ *          Q_SIMD_SSE2, Q_SIMD_AVX2 and Q_SIMD_AVX512 are 1 when kernels for
+ *          that instruction set are compiled.
+ *
+ * @note    Set the environment variable Q_ISA to scalar, sse2, sse4.1, avx2
+ *          or avx512 to pin a lower tier, e.g. for testing. It is read once,
+ *          before main(); a tier above what the CPU has is ignored.
+ * @note    Define Q_SIMD_DISABLE to force the plain C kernels.
+ * @note    SSE4.1 is detected as its own tier; no kernel needs it yet, so it
+ *          runs the SSE2 kernels.
+ */
+
+#ifndef SRC_Q_SIMD_H_
+#define SRC_Q_SIMD_H_
+
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Kernel tiers, each includes the ones below.
+ */
+typedef enum
+{
+    Q_ISA_SCALAR = 0,   /**< Plain C loops over the Q macros. */
+    Q_ISA_SSE2,         /**< SSE2. */
+    Q_ISA_SSE41,        /**< SSE4.1. */
+    Q_ISA_AVX2,         /**< AVX2, F16C and POPCNT. */
+    Q_ISA_AVX512        /**< AVX-512 F, BW, DQ, VL, F16C and POPCNT. */
+} q_isa_t;
+
+
+#if !defined(Q_SIMD_DISABLE) && (defined(__x86_64__) || defined(__i386__) || defined(_M_X64))
+
+#include <immintrin.h>
+
+#if defined(__GNUC__) || defined(__clang__)
+
+#include <cpuid.h>
+
+#define Q_SIMD_DISPATCH 1
+#define Q_SIMD_SSE2     1
+#define Q_SIMD_AVX2     1
+#define Q_SIMD_AVX512   1
+
+#if defined(__clang__)
+#define Q_TARGET_SSE2_BEGIN     _Pragma("clang attribute push(__attribute__((target(\"sse2\"))), apply_to = function)")
+#define Q_TARGET_AVX2_BEGIN     _Pragma("clang attribute push(__attribute__((target(\"avx2,f16c,popcnt\"))), apply_to = function)")
+#define Q_TARGET_AVX512_BEGIN   _Pragma("clang attribute push(__attribute__((target(\"avx512f,avx512bw,avx512dq,avx512vl,f16c,popcnt\"))), apply_to = function)")
+#define Q_TARGET_END            _Pragma("clang attribute pop")
+#else
+#define Q_TARGET_SSE2_BEGIN     _Pragma("GCC push_options") _Pragma("GCC target(\"sse2\")")
+#define Q_TARGET_AVX2_BEGIN     _Pragma("GCC push_options") _Pragma("GCC target(\"avx2,f16c,popcnt\")")
+#define Q_TARGET_AVX512_BEGIN   _Pragma("GCC push_options") _Pragma("GCC target(\"avx512f,avx512bw,avx512dq,avx512vl,f16c,popcnt\")")
+#define Q_TARGET_END            _Pragma("GCC pop_options")
+#endif
+
+#else /* Other compilers: what the flags allow. */
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define Q_SIMD_SSE2     1
+#endif
+
+#if defined(__AVX2__)
+#define Q_SIMD_AVX2     1
+#endif
+
+#if defined(__AVX512F__) && defined(__AVX512BW__) && defined(__AVX512DQ__) && defined(__AVX512VL__)
+#define Q_SIMD_AVX512   1
+#endif
+
+#endif
+
+#endif
+
+#ifndef Q_SIMD_DISPATCH
+#define Q_SIMD_DISPATCH 0
+#endif
+#ifndef Q_SIMD_SSE2
+#define Q_SIMD_SSE2     0
+#endif
+#ifndef Q_SIMD_AVX2
+#define Q_SIMD_AVX2     0
+#endif
+#ifndef Q_SIMD_AVX512
+#define Q_SIMD_AVX512   0
+#endif
+
+#ifndef Q_TARGET_SSE2_BEGIN
+#define Q_TARGET_SSE2_BEGIN
+#define Q_TARGET_AVX2_BEGIN
+#define Q_TARGET_AVX512_BEGIN
+#define Q_TARGET_END
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define Q_CONSTRUCTOR   __attribute__((constructor))    /**< Runs before main(). */
+#else
+#define Q_CONSTRUCTOR
+#endif
+
+
+/** @brief Highest tier the CPU (or, without dispatch, the compiler flags) allows. @note RARELY USE DIRECTLY. */
+static inline q_isa_t q_isa_detect(void)
+{
+#if Q_SIMD_DISPATCH
+    __builtin_cpu_init();   /* Needed when called from a constructor. */
+    unsigned int a, b, c, d;
+    /* F16C from CPUID leaf 1 (ECX bit 29), older compilers have no name for it. */
+    int f16c   = __get_cpuid(1, &a, &b, &c, &d) && (c & bit_F16C) != 0;
+    int base   = __builtin_cpu_supports("popcnt") && f16c;     /* Needed by both upper tiers. */
+    if (base && __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+        __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512vl"))
+    {
+        return Q_ISA_AVX512;
+    }
+    if (base && __builtin_cpu_supports("avx2"))
+    {
+        return Q_ISA_AVX2;
+    }
+    if (__builtin_cpu_supports("sse4.1"))
+    {
+        return Q_ISA_SSE41;
+    }
+    if (__builtin_cpu_supports("sse2"))
+    {
+        return Q_ISA_SSE2;
+    }
+    return Q_ISA_SCALAR;
+#elif Q_SIMD_AVX512
+    return Q_ISA_AVX512;
+#elif Q_SIMD_AVX2
+    return Q_ISA_AVX2;
+#elif Q_SIMD_SSE2 && defined(__SSE4_1__)
+    return Q_ISA_SSE41;
+#elif Q_SIMD_SSE2
+    return Q_ISA_SSE2;
+#else
+    return Q_ISA_SCALAR;
+#endif
+}
+
+/** @brief Name of a tier, same strings as Q_ISA accepts. */
+static inline const char *q_isa_name(q_isa_t isa)
+{
+    static const char *const names[] = { "scalar", "sse2", "sse4.1", "avx2", "avx512" };
+    return (unsigned int)isa <= Q_ISA_AVX512 ? names[isa] : "?";
+}
+
+/** @brief Tier the kernel tables are bound to: q_isa_detect(), lowered by Q_ISA. Detected once. */
+static inline q_isa_t q_isa(void)
+{
+    static int isa = -1;
+
+    if (isa < 0)
+    {
+        q_isa_t     det = q_isa_detect();
+        q_isa_t     req = det;
+        const char *env = getenv("Q_ISA");
+
+        if (env != NULL)
+        {
+            for (int t = Q_ISA_SCALAR; t <= Q_ISA_AVX512; t++)
+            {
+                if (strcmp(env, q_isa_name((q_isa_t)t)) == 0)
+                {
+                    req = (q_isa_t)t;
+                }
+            }
+        }
+        isa = req < det ? req : det;
+    }
+    return (q_isa_t)isa;
+}
+
+
+#endif /* SRC_Q_SIMD_H_ */
@@ -0,0 +1,313 @@
+/*
+ * qconv - converts raw sample files between float32 and Q formats.
+ *
+ * Build:  gcc -std=c99 -O2 -o qconv qconv.c
+ *
+ * Usage:  qconv [options] <in> <out>
+ *   --q N          fraction bits (default 15)
+ *   --bits W       word size 8, 16, 32 or 64 (default 16)
+ *   --decode       Q to float32 instead of float32 to Q
+ *   --round MODE   trunc (default, same as Qx_bxx), rne, away, floor, stoch;
+ *                  stoch uses the element index as counter, so output is
+ *                  reproducible
+ *   --chunk MIB    input window in MiB (default 16)
+ *   --mmap-out     write through a shared mapping of the output file
+ *                  instead of write()
+ *   --advise       sequential/read-ahead hints (posix_madvise, posix_fadvise)
+ *   -v             print size and throughput to stderr
+ *
+ * Examples:
+ *   qconv --q 15 --bits 16 capture.f32 capture.q15
+ *   qconv --decode --q 31 --bits 32 capture.q31 capture.f32
+ *
+ * The input is mapped one window at a time and unmapped after conversion,
+ * so memory use is one window (plus one output buffer with write()),
+ * whatever the file size. Files are raw native-endian arrays with no header.
+ * */
+#define _POSIX_C_SOURCE 200112L
+
+#include "q_round.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef struct
+{
+    unsigned int N;
+    unsigned int bits;
+    int          decode;
+    int          round;     /* 0: plain Qx_bxx_array(), else q_round_t in mode. */
+    q_round_t    mode;
+    size_t       chunk;     /* Bytes of input per window. */
+    int          mmap_out;
+    int          advise;
+    int          verbose;
+} opt_t;
+
+static int usage(void)
+{
+    fprintf(stderr, "usage: qconv [--q N] [--bits 8|16|32|64] [--decode] [--round trunc|rne|away|floor|stoch]\n"
+                    "             [--chunk MIB] [--mmap-out] [--advise] [-v] <in> <out>\n");
+    return 2;
+}
+
+static int fail(const char *what, const char *name)
+{
+    fprintf(stderr, "qconv: %s %s: %s\n", what, name, strerror(errno));
+    return 1;
+}
+
+/* Converts n elements, first is the index of src[0] in the file. */
+static void convert(const opt_t *o, void *dst, const void *src, size_t n, size_t first)
+{
+    uint32_t ctr = (uint32_t)first;
+
+    switch (o->bits)
+    {
+        case 8:
+            if (o->decode)      F_Qx_b08_array(o->N, (float32_t *)dst, (const fix8_t *)src, n);
+            else if (o->round)  Qx_b08_array_r(o->N, (fix8_t *)dst, (const float32_t *)src, n, o->mode, ctr);
+            else                Qx_b08_array(o->N, (fix8_t *)dst, (const float32_t *)src, n);
+            break;
+        case 16:
+            if (o->decode)      F_Qx_b16_array(o->N, (float32_t *)dst, (const fix16_t *)src, n);
+            else if (o->round)  Qx_b16_array_r(o->N, (fix16_t *)dst, (const float32_t *)src, n, o->mode, ctr);
+            else                Qx_b16_array(o->N, (fix16_t *)dst, (const float32_t *)src, n);
+            break;
+        case 32:
+            if (o->decode)      F_Qx_b32_array(o->N, (float32_t *)dst, (const fix32_t *)src, n);
+            else if (o->round)  Qx_b32_array_r(o->N, (fix32_t *)dst, (const float32_t *)src, n, o->mode, ctr);
+            else                Qx_b32_array(o->N, (fix32_t *)dst, (const float32_t *)src, n);
+            break;
+        default:
+            if (o->decode)      F_Qx_b64_array(o->N, (float32_t *)dst, (const fix64_t *)src, n);
+            else if (o->round)  Qx_b64_array_r(o->N, (fix64_t *)dst, (const float32_t *)src, n, o->mode, ctr);
+            else                Qx_b64_array(o->N, (fix64_t *)dst, (const float32_t *)src, n);
+            break;
+    }
+}
+
+static int write_all(int fd, const void *buf, size_t bytes)
+{
+    const char *p = (const char *)buf;
+
+    while (bytes > 0)
+    {
+        ssize_t w = write(fd, p, bytes);
+        if (w < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (w <= 0)
+        {
+            return -1;
+        }
+        p     += w;
+        bytes -= (size_t)w;
+    }
+    return 0;
+}
+
+/* Parses all of s as a decimal in 1 .. max. Sign, junk, overflow and 0 give -1. */
+static int parse_num(const char *s, unsigned long max, unsigned long *v)
+{
+    char *end;
+
+    if (s[0] < '0' || s[0] > '9')
+    {
+        return -1;
+    }
+    errno = 0;
+    *v    = strtoul(s, &end, 10);
+    return errno != 0 || *end != '\0' || *v == 0 || *v > max ? -1 : 0;
+}
+
+static int parse(int argc, char **argv, opt_t *o, const char **in, const char **out)
+{
+    static const char *const modes[] = { "trunc", "rne", "away", "floor", "stoch" };
+    int files = 0;
+    unsigned long v;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char *a   = argv[i];
+        const char *val = i + 1 < argc ? argv[i + 1] : NULL;
+
+        if (strcmp(a, "--q") == 0 && val)
+        {
+            if (parse_num(val, 63, &v) != 0)
+            {
+                return -1;
+            }
+            o->N = (unsigned int)v;
+            i++;
+        }
+        else if (strcmp(a, "--bits") == 0 && val)
+        {
+            if (parse_num(val, 64, &v) != 0)
+            {
+                return -1;
+            }
+            o->bits = (unsigned int)v;
+            i++;
+        }
+        else if (strcmp(a, "--chunk") == 0 && val)
+        {
+            if (parse_num(val, (unsigned long)(SIZE_MAX >> 20), &v) != 0)
+            {
+                return -1;
+            }
+            o->chunk = (size_t)v << 20;
+            i++;
+        }
+        else if (strcmp(a, "--decode") == 0)        { o->decode = 1; }
+        else if (strcmp(a, "--mmap-out") == 0)      { o->mmap_out = 1; }
+        else if (strcmp(a, "--advise") == 0)        { o->advise = 1; }
+        else if (strcmp(a, "-v") == 0)              { o->verbose = 1; }
+        else if (strcmp(a, "--round") == 0 && val)
+        {
+            int m = -1;
+            for (int k = 0; k < 5; k++)
+            {
+                m = strcmp(val, modes[k]) == 0 ? k : m;
+            }
+            if (m < 0)
+            {
+                return -1;
+            }
+            o->round = m != Q_ROUND_TRUNC;
+            o->mode  = (q_round_t)m;
+            i++;
+        }
+        else if (a[0] != '-' && files < 2)          { *(files++ == 0 ? in : out) = a; }
+        else                                        { return -1; }
+    }
+    if (files != 2 || (o->bits != 8 && o->bits != 16 && o->bits != 32 && o->bits != 64) ||
+        o->N < 1 || o->N > o->bits - 1 || o->chunk == 0)
+    {
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    opt_t       o   = { 15, 16, 0, 0, Q_ROUND_TRUNC, (size_t)16 << 20, 0, 0, 0 };
+    const char *in  = NULL;
+    const char *out = NULL;
+
+    if (parse(argc, argv, &o, &in, &out) != 0)
+    {
+        return usage();
+    }
+
+    size_t isz = o.decode ? o.bits / 8 : sizeof(float32_t);
+    size_t osz = o.decode ? sizeof(float32_t) : o.bits / 8;
+
+    int ifd = open(in, O_RDONLY);
+    if (ifd < 0)
+    {
+        return fail("cannot open", in);
+    }
+    struct stat st;
+    if (fstat(ifd, &st) != 0)
+    {
+        return fail("cannot stat", in);
+    }
+    if ((size_t)st.st_size % isz != 0)
+    {
+        fprintf(stderr, "qconv: %s: size %lld is not a multiple of %zu bytes\n", in, (long long)st.st_size, isz);
+        return 1;
+    }
+    size_t n = (size_t)st.st_size / isz;
+
+    int ofd = open(out, (o.mmap_out ? O_RDWR : O_WRONLY) | O_CREAT | O_TRUNC, 0644);
+    if (ofd < 0)
+    {
+        return fail("cannot create", out);
+    }
+    if (o.mmap_out && ftruncate(ofd, (off_t)(n * osz)) != 0)
+    {
+        return fail("cannot size", out);
+    }
+    if (o.advise)
+    {
+        posix_fadvise(ifd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+
+    /* Window of whole pages in both files: a multiple of page size elements. */
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t win  = o.chunk / isz / page * page;
+    win = win == 0 ? page : win;
+
+    void *buf = NULL;
+    if (!o.mmap_out && n > 0)
+    {
+        buf = malloc((n < win ? n : win) * osz);
+        if (buf == NULL)
+        {
+            return fail("out of memory for", out);
+        }
+    }
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    for (size_t first = 0; first < n; first += win)
+    {
+        size_t m   = n - first < win ? n - first : win;
+        void  *src = mmap(NULL, m * isz, PROT_READ, MAP_PRIVATE, ifd, (off_t)(first * isz));
+        if (src == MAP_FAILED)
+        {
+            return fail("cannot map", in);
+        }
+        if (o.advise)
+        {
+            posix_madvise(src, m * isz, POSIX_MADV_SEQUENTIAL);
+            posix_madvise(src, m * isz, POSIX_MADV_WILLNEED);
+        }
+
+        if (o.mmap_out)
+        {
+            void *dst = mmap(NULL, m * osz, PROT_READ | PROT_WRITE, MAP_SHARED, ofd, (off_t)(first * osz));
+            if (dst == MAP_FAILED)
+            {
+                return fail("cannot map", out);
+            }
+            convert(&o, dst, src, m, first);
+            munmap(dst, m * osz);
+        }
+        else
+        {
+            convert(&o, buf, src, m, first);
+            if (write_all(ofd, buf, m * osz) != 0)
+            {
+                return fail("cannot write", out);
+            }
+        }
+        munmap(src, m * isz);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    free(buf);
+    close(ifd);
+    if (close(ofd) != 0)
+    {
+        return fail("cannot close", out);
+    }
+
+    if (o.verbose)
+    {
+        double s = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) * 1e-9;
+        fprintf(stderr, "qconv: %zu elements, %.1f MB in, %.3f s, %.1f MB/s (%s kernels)\n", n,
+                (double)(n * isz) * 1e-6, s, s > 0.0 ? (double)(n * isz) * 1e-6 / s : 0.0, q_isa_name(q_isa()));
+    }
+    return 0;
+}
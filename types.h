@@ -12,6 +12,16 @@
 
 #include <stdint.h>
 
+/**
+* @brief Two fixed point signed 4-bit numbers in one byte, element 2i in the low nibble.
+*/
+typedef uint8_t fix4x2_t;
+
+/**
+* @brief Four fixed point signed 2-bit numbers in one byte, element 4i in the low bits.
+*/
+typedef uint8_t fix2x4_t;
+
 /**
 * @brief Fixed point signed 8-bit number.
 */
@@ -42,5 +52,15 @@ typedef float float32_t;
 */
 typedef double float64_t;
 
+/**
+* @brief IEEE 754 half precision (binary16) value, stored as its bits.
+*/
+typedef uint16_t fp16_t;
+
+/**
+* @brief bfloat16 value (upper half of a float32), stored as its bits.
+*/
+typedef uint16_t bf16_t;
+
 
 #endif /* SRC_TYPES_H_ */